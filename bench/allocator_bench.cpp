@@ -0,0 +1,148 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+#include "corpus.hpp"
+
+#include "json_writer.hpp"
+
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+namespace {
+// Each iteration serves REQUEST_COUNT requests split between the threads. A
+// request writes a response of RECORDS_PER_REQUEST log records with a fresh
+// writer, whose buffer comes either from the global heap or from an arena
+// released at the end of the request.
+constexpr int REQUEST_COUNT = 1024;
+constexpr int RECORDS_PER_REQUEST = 32;
+constexpr size_t ARENA_SIZE = 16 * 1024;
+
+template<class Writer>
+void
+write_response(Writer& writer, const std::vector<LogRecord>& records, int request)
+{
+  writer.begin_array();
+  for (int i = 0; i < RECORDS_PER_REQUEST; ++i) {
+    const LogRecord& record = records[(request * RECORDS_PER_REQUEST + i) % records.size()];
+    writer.begin_array_item();
+    writer.begin_object();
+    writer.write_integer_field("timestamp", record.timestamp);
+    writer.write_string_field("level", record.level);
+    writer.write_string_field("logger", record.logger);
+    writer.write_string_field("message", record.message);
+    writer.write_integer_field("thread_id", record.thread_id);
+    writer.end_object();
+    writer.end_array_item();
+  }
+  writer.end_array();
+}
+
+size_t
+get_output_size()
+{
+  const std::vector<LogRecord>& records = get_corpus().log_records;
+  size_t size = 0;
+  for (int request = 0; request < REQUEST_COUNT; ++request) {
+    CompactJsonWriter writer;
+    write_response(writer, records, request);
+    size += writer.get_buffer().size();
+  }
+  return size;
+}
+
+template<class F>
+void
+run_requests(BenchState& state, int thread_count, F serve)
+{
+  while (state.keep_running()) {
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < thread_count; ++thread) {
+      threads.emplace_back([=] {
+        for (int request = thread; request < REQUEST_COUNT; request += thread_count)
+          serve(request);
+      });
+    }
+    for (std::thread& thread : threads)
+      thread.join();
+  }
+  state.set_bytes_per_iteration(get_output_size());
+}
+
+void
+run_malloc(BenchState& state, int thread_count)
+{
+  const std::vector<LogRecord>& records = get_corpus().log_records;
+  run_requests(state, thread_count, [&](int request) {
+    CompactJsonWriter writer;
+    write_response(writer, records, request);
+    do_not_optimize(writer.get_buffer().data());
+  });
+}
+
+// The arena starts in a buffer on the stack of the request and only falls back
+// to the heap for larger responses.
+void
+run_arena(BenchState& state, int thread_count)
+{
+  const std::vector<LogRecord>& records = get_corpus().log_records;
+  run_requests(state, thread_count, [&](int request) {
+    char storage[ARENA_SIZE];
+    std::pmr::monotonic_buffer_resource arena(storage, sizeof(storage));
+    PmrCompactJsonWriter writer(&arena);
+    write_response(writer, records, request);
+    do_not_optimize(writer.get_buffer().data());
+  });
+}
+
+// The arena only gets heap blocks, released together with the arena.
+void
+run_heap_arena(BenchState& state, int thread_count)
+{
+  const std::vector<LogRecord>& records = get_corpus().log_records;
+  run_requests(state, thread_count, [&](int request) {
+    std::pmr::monotonic_buffer_resource arena(ARENA_SIZE);
+    PmrCompactJsonWriter writer(&arena);
+    write_response(writer, records, request);
+    do_not_optimize(writer.get_buffer().data());
+  });
+}
+} // namespace
+
+#define ALLOCATOR_BENCH(thread_count)                                                                                  \
+  BENCH(allocator_malloc_##thread_count)                                                                               \
+  {                                                                                                                    \
+    run_malloc(state, thread_count);                                                                                   \
+  }                                                                                                                    \
+  BENCH(allocator_arena_##thread_count)                                                                                \
+  {                                                                                                                    \
+    run_arena(state, thread_count);                                                                                    \
+  }                                                                                                                    \
+  BENCH(allocator_heap_arena_##thread_count)                                                                           \
+  {                                                                                                                    \
+    run_heap_arena(state, thread_count);                                                                               \
+  }
+
+ALLOCATOR_BENCH(1)
+ALLOCATOR_BENCH(4)
+ALLOCATOR_BENCH(16)
@@ -0,0 +1,75 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+
+#include "json_writer.hpp"
+
+#include <cstdio>
+
+namespace {
+// Time spent by the producer writing one log record, with the output going to
+// /dev/null either synchronously or through the background I/O thread.
+void
+write_record(CompactJsonWriter& writer, uint64_t i)
+{
+  writer.begin_object();
+  writer.write_integer_field("timestamp", 1700000000000 + i);
+  writer.write_string_field("level", "info");
+  writer.write_string_field("message", "user logged in from a new device");
+  writer.write_integer_field("user_id", i * 7919);
+  writer.end_object();
+}
+
+void
+run_log_records(BenchState& state, JsonSink& sink)
+{
+  CompactJsonWriter writer;
+  write_record(writer, 0);
+  state.set_bytes_per_iteration(writer.get_buffer().size());
+  writer.reset();
+
+  writer.set_sink(&sink, 4096);
+  uint64_t i = 0;
+  while (state.keep_running())
+    write_record(writer, i++);
+  writer.flush();
+}
+} // namespace
+
+BENCH(sink_log_records_file)
+{
+  FILE* file = std::fopen("/dev/null", "wb");
+  JsonFileSink sink(file);
+  run_log_records(state, sink);
+  std::fclose(file);
+}
+
+BENCH(sink_log_records_async)
+{
+  FILE* file = std::fopen("/dev/null", "wb");
+  {
+    JsonAsyncFileSink sink(file, 4, 64 * 1024);
+    run_log_records(state, sink);
+  }
+  std::fclose(file);
+}
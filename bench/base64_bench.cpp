@@ -0,0 +1,109 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+
+#include "json_writer.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+const std::vector<unsigned char>&
+get_data()
+{
+  static const std::vector<unsigned char> data = [] {
+    std::vector<unsigned char> bytes(256 * 1024);
+    uint32_t state = 1;
+    for (unsigned char& byte : bytes) {
+      state = state * 1103515245 + 12345;
+      byte = static_cast<unsigned char>(state >> 16);
+    }
+    return bytes;
+  }();
+  return data;
+}
+
+// What callers did before write_base64(): encode into a temporary string, then
+// write it as a string, which scans it for characters to escape and copies it.
+std::string
+encode_to_string(const unsigned char* data, size_t size)
+{
+  static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string encoded((size + 2) / 3 * 4, '=');
+  char* out = encoded.data();
+  for (; size >= 3; data += 3, size -= 3) {
+    const uint32_t bits = (uint32_t(data[0]) << 16) | (uint32_t(data[1]) << 8) | data[2];
+    *out++ = ALPHABET[bits >> 18];
+    *out++ = ALPHABET[(bits >> 12) & 0x3F];
+    *out++ = ALPHABET[(bits >> 6) & 0x3F];
+    *out++ = ALPHABET[bits & 0x3F];
+  }
+  if (size != 0) {
+    const uint32_t bits = (uint32_t(data[0]) << 16) | (size == 2 ? uint32_t(data[1]) << 8 : 0);
+    *out++ = ALPHABET[bits >> 18];
+    *out++ = ALPHABET[(bits >> 12) & 0x3F];
+    if (size == 2)
+      *out = ALPHABET[(bits >> 6) & 0x3F];
+  }
+  return encoded;
+}
+
+void
+run_write_base64(BenchState& state, size_t size)
+{
+  state.set_bytes_per_iteration(size);
+  CompactJsonWriter writer;
+  while (state.keep_running()) {
+    writer.reset();
+    writer.write_base64(get_data().data(), size);
+    do_not_optimize(writer.get_buffer().data());
+  }
+}
+
+void
+run_write_temporary(BenchState& state, size_t size)
+{
+  state.set_bytes_per_iteration(size);
+  CompactJsonWriter writer;
+  while (state.keep_running()) {
+    writer.reset();
+    writer.write_string(encode_to_string(get_data().data(), size));
+    do_not_optimize(writer.get_buffer().data());
+  }
+}
+} // namespace
+
+#define BASE64_BENCH(name, size)                                                                                       \
+  BENCH(base64_##name)                                                                                                 \
+  {                                                                                                                    \
+    run_write_base64(state, size);                                                                                     \
+  }                                                                                                                    \
+  BENCH(base64_##name##_temporary)                                                                                     \
+  {                                                                                                                    \
+    run_write_temporary(state, size);                                                                                  \
+  }
+
+BASE64_BENCH(32, 32)
+BASE64_BENCH(4k, 4 * 1024)
+BASE64_BENCH(256k, 256 * 1024)
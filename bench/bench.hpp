@@ -0,0 +1,120 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Number of heap allocations performed so far by the whole program.
+uint64_t
+get_allocation_count();
+
+class BenchState
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit BenchState(Clock::duration min_time)
+    : m_min_time(min_time)
+  {
+  }
+
+  // Returns true while the benchmark loop should run another iteration. The
+  // clock is only sampled once per batch so that cheap operations are not
+  // dominated by the cost of reading the time.
+  bool keep_running()
+  {
+    if (m_remaining_in_batch > 0) {
+      --m_remaining_in_batch;
+      ++m_iterations;
+      return true;
+    }
+
+    const Clock::time_point now = Clock::now();
+    if (m_iterations == 0) {
+      m_start = now;
+      m_start_allocations = get_allocation_count();
+    } else {
+      m_elapsed = now - m_start;
+      if (m_elapsed >= m_min_time) {
+        m_allocations = get_allocation_count() - m_start_allocations;
+        return false;
+      }
+    }
+
+    if (m_batch_size < (1u << 20))
+      m_batch_size *= 2;
+    m_remaining_in_batch = m_batch_size - 1;
+    ++m_iterations;
+    return true;
+  }
+
+  // Number of input or output bytes processed by a single iteration, used to
+  // report the throughput.
+  void set_bytes_per_iteration(size_t bytes) { m_bytes_per_iteration = bytes; }
+
+  uint64_t get_iterations() const { return m_iterations; }
+  size_t get_bytes_per_iteration() const { return m_bytes_per_iteration; }
+  Clock::duration get_elapsed() const { return m_elapsed; }
+  uint64_t get_allocations() const { return m_allocations; }
+
+private:
+  Clock::duration m_min_time;
+  Clock::time_point m_start;
+  Clock::duration m_elapsed{};
+  uint64_t m_iterations = 0;
+  uint64_t m_batch_size = 1;
+  uint64_t m_remaining_in_batch = 0;
+  size_t m_bytes_per_iteration = 0;
+  uint64_t m_start_allocations = 0;
+  uint64_t m_allocations = 0;
+};
+
+using BenchFunc = void (*)(BenchState& state);
+
+struct BenchRegistrar
+{
+  BenchRegistrar(const char* name, BenchFunc func);
+};
+
+#define BENCH(name)                                                                                                    \
+  static void bench_##name(BenchState& state);                                                                         \
+  static BenchRegistrar bench_registrar_##name(#name, bench_##name);                                                   \
+  static void bench_##name(BenchState& state)
+
+// Prevents the compiler from optimizing away the computation of value.
+template<class T>
+inline void
+do_not_optimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void* sink;
+  sink = &value;
+#endif
+}
+
+#endif
@@ -0,0 +1,123 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "corpus.hpp"
+
+namespace {
+// xorshift64*, used instead of <random> distributions whose output is
+// implementation-defined.
+class Random
+{
+public:
+  uint64_t next()
+  {
+    m_state ^= m_state >> 12;
+    m_state ^= m_state << 25;
+    m_state ^= m_state >> 27;
+    return m_state * 0x2545F4914F6CDD1DULL;
+  }
+
+  uint64_t next_below(uint64_t bound) { return next() % bound; }
+  double next_double() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+
+private:
+  uint64_t m_state = 0x9E3779B97F4A7C15ULL;
+};
+
+const char* const LEVELS[] = { "DEBUG", "INFO", "INFO", "INFO", "WARN", "ERROR" };
+const char* const LOGGERS[] = { "http.server", "db.pool", "auth", "scheduler", "cache" };
+const char* const WORDS[] = { "request", "handled", "user",    "connection", "timeout", "retry",
+                              "query",   "failed",  "session", "expired",    "cache",   "miss" };
+// Text with characters that must be escaped and multi-byte UTF-8 sequences.
+const char* const FRAGMENTS[] = { "path=\"/api/v1/items\"",
+                                  "C:\\Users\\build\\log.txt",
+                                  "line one\nline two\ttabbed",
+                                  "caf\xc3\xa9 na\xc3\xafve r\xc3\xa9sum\xc3\xa9",
+                                  "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e\xe3\x81\xae\xe3\x83\x86\xe3\x82\xad\xe3\x82\xb9"
+                                  "\xe3\x83\x88",
+                                  "plain ascii words without anything special in them" };
+
+template<class T, size_t N>
+const T&
+pick(Random& random, const T (&values)[N])
+{
+  return values[random.next_below(N)];
+}
+
+std::string
+make_sentence(Random& random, size_t word_count)
+{
+  std::string sentence;
+  for (size_t i = 0; i < word_count; ++i) {
+    if (i != 0)
+      sentence.push_back(' ');
+    sentence.append(pick(random, WORDS));
+  }
+  return sentence;
+}
+
+Corpus
+make_corpus()
+{
+  Random random;
+  Corpus corpus;
+
+  for (int i = 0; i < 1000; ++i) {
+    LogRecord record;
+    record.timestamp = 1686564942000 + i * 17;
+    record.level = pick(random, LEVELS);
+    record.logger = pick(random, LOGGERS);
+    record.message = make_sentence(random, 4 + random.next_below(12));
+    record.thread_id = static_cast<int>(random.next_below(64));
+    record.duration_ms = random.next_double() * 250.0;
+    record.success = random.next_below(10) != 0;
+    corpus.log_records.push_back(std::move(record));
+  }
+
+  corpus.nesting_depth = 500;
+
+  for (int i = 0; i < 10000; ++i) {
+    corpus.floats.push_back((random.next_double() - 0.5) * 2e6);
+    corpus.integers.push_back(static_cast<int64_t>(random.next()) >> random.next_below(63));
+  }
+
+  for (int i = 0; i < 1000; ++i) {
+    std::string value;
+    const size_t fragment_count = 1 + random.next_below(8);
+    for (size_t j = 0; j < fragment_count; ++j)
+      value.append(pick(random, FRAGMENTS));
+    corpus.strings.push_back(std::move(value));
+  }
+
+  for (int i = 0; i < 2000; ++i)
+    corpus.wide_object_keys.push_back(std::string(pick(random, WORDS)) + "_" + std::to_string(i));
+
+  return corpus;
+}
+} // namespace
+
+const Corpus&
+get_corpus()
+{
+  static const Corpus corpus = make_corpus();
+  return corpus;
+}
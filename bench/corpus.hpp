@@ -0,0 +1,170 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef CORPUS_HPP
+#define CORPUS_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Synthetic inputs shared by the benchmarks. They are generated from a fixed
+// seed so that every run (and every machine) serializes the same documents.
+
+struct LogRecord
+{
+  int64_t timestamp;
+  std::string level;
+  std::string logger;
+  std::string message;
+  int thread_id;
+  double duration_ms;
+  bool success;
+};
+
+struct Corpus
+{
+  std::vector<LogRecord> log_records;
+  int nesting_depth;
+  std::vector<double> floats;
+  std::vector<int64_t> integers;
+  std::vector<std::string> strings;
+  std::vector<std::string> wide_object_keys;
+};
+
+const Corpus&
+get_corpus();
+
+template<class Writer>
+void
+write_log_records(Writer& writer, const std::vector<LogRecord>& records)
+{
+  writer.begin_array();
+  for (const LogRecord& record : records) {
+    writer.begin_array_item();
+    writer.begin_object();
+    writer.write_integer_field("timestamp", record.timestamp);
+    writer.write_string_field("level", record.level);
+    writer.write_string_field("logger", record.logger);
+    writer.write_string_field("message", record.message);
+    writer.write_integer_field("thread_id", record.thread_id);
+    writer.write_float_field("duration_ms", record.duration_ms);
+    writer.write_bool_field("success", record.success);
+    writer.write_null_field("parent_span");
+    writer.end_object();
+    writer.end_array_item();
+  }
+  writer.end_array();
+}
+
+template<class Writer>
+void
+write_deep_nesting(Writer& writer, int depth)
+{
+  for (int i = 0; i < depth; ++i) {
+    if (i % 2 == 0) {
+      writer.begin_object();
+      writer.write_integer_field("level", i);
+      writer.begin_field("child");
+    } else {
+      writer.begin_array();
+      writer.begin_array_item();
+    }
+  }
+
+  writer.write_null();
+
+  for (int i = depth - 1; i >= 0; --i) {
+    if (i % 2 == 0) {
+      writer.end_field();
+      writer.end_object();
+    } else {
+      writer.end_array_item();
+      writer.end_array();
+    }
+  }
+}
+
+template<class Writer>
+void
+write_numeric_arrays(Writer& writer, const std::vector<double>& floats, const std::vector<int64_t>& integers)
+{
+  writer.begin_object();
+
+  writer.begin_field("floats");
+  writer.begin_array();
+  for (double value : floats) {
+    writer.begin_array_item();
+    writer.write_float(value);
+    writer.end_array_item();
+  }
+  writer.end_array();
+  writer.end_field();
+
+  writer.begin_field("integers");
+  writer.begin_array();
+  for (int64_t value : integers) {
+    writer.begin_array_item();
+    writer.write_integer(value);
+    writer.end_array_item();
+  }
+  writer.end_array();
+  writer.end_field();
+
+  writer.end_object();
+}
+
+template<class Writer>
+void
+write_strings(Writer& writer, const std::vector<std::string>& strings)
+{
+  writer.begin_array();
+  for (const std::string& value : strings) {
+    writer.begin_array_item();
+    writer.write_string(value);
+    writer.end_array_item();
+  }
+  writer.end_array();
+}
+
+template<class Writer>
+void
+write_wide_object(Writer& writer, const std::vector<std::string>& keys)
+{
+  writer.begin_object();
+  for (size_t i = 0; i < keys.size(); ++i) {
+    switch (i % 3) {
+      case 0:
+        writer.write_integer_field(keys[i], i);
+        break;
+      case 1:
+        writer.write_bool_field(keys[i], i % 2 == 0);
+        break;
+      default:
+        writer.write_string_field(keys[i], "value");
+        break;
+    }
+  }
+  writer.end_object();
+}
+
+#endif
@@ -0,0 +1,155 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+#include "corpus.hpp"
+
+#include "json_writer.hpp"
+
+namespace {
+enum class Mode
+{
+  Compact,
+  Pretty,
+  Colored,
+};
+
+template<class F>
+void
+run_corpus(BenchState& state, Mode mode, F write)
+{
+  const Corpus& corpus = get_corpus();
+  while (state.keep_running()) {
+    JsonWriter writer;
+    writer.set_pretty(mode != Mode::Compact);
+    writer.set_use_colors(mode == Mode::Colored);
+    write(writer, corpus);
+    state.set_bytes_per_iteration(writer.get_buffer().size());
+    do_not_optimize(writer.get_buffer().data());
+  }
+}
+
+void
+write_log_corpus(JsonWriter& writer, const Corpus& corpus)
+{
+  write_log_records(writer, corpus.log_records);
+}
+
+void
+write_nesting_corpus(JsonWriter& writer, const Corpus& corpus)
+{
+  write_deep_nesting(writer, corpus.nesting_depth);
+}
+
+void
+write_numeric_corpus(JsonWriter& writer, const Corpus& corpus)
+{
+  write_numeric_arrays(writer, corpus.floats, corpus.integers);
+}
+
+void
+write_string_corpus(JsonWriter& writer, const Corpus& corpus)
+{
+  write_strings(writer, corpus.strings);
+}
+
+void
+write_wide_corpus(JsonWriter& writer, const Corpus& corpus)
+{
+  write_wide_object(writer, corpus.wide_object_keys);
+}
+} // namespace
+
+BENCH(corpus_log_compact)
+{
+  run_corpus(state, Mode::Compact, write_log_corpus);
+}
+
+BENCH(corpus_log_pretty)
+{
+  run_corpus(state, Mode::Pretty, write_log_corpus);
+}
+
+BENCH(corpus_log_colored)
+{
+  run_corpus(state, Mode::Colored, write_log_corpus);
+}
+
+BENCH(corpus_nesting_compact)
+{
+  run_corpus(state, Mode::Compact, write_nesting_corpus);
+}
+
+BENCH(corpus_nesting_pretty)
+{
+  run_corpus(state, Mode::Pretty, write_nesting_corpus);
+}
+
+BENCH(corpus_nesting_colored)
+{
+  run_corpus(state, Mode::Colored, write_nesting_corpus);
+}
+
+BENCH(corpus_numeric_compact)
+{
+  run_corpus(state, Mode::Compact, write_numeric_corpus);
+}
+
+BENCH(corpus_numeric_pretty)
+{
+  run_corpus(state, Mode::Pretty, write_numeric_corpus);
+}
+
+BENCH(corpus_numeric_colored)
+{
+  run_corpus(state, Mode::Colored, write_numeric_corpus);
+}
+
+BENCH(corpus_strings_compact)
+{
+  run_corpus(state, Mode::Compact, write_string_corpus);
+}
+
+BENCH(corpus_strings_pretty)
+{
+  run_corpus(state, Mode::Pretty, write_string_corpus);
+}
+
+BENCH(corpus_strings_colored)
+{
+  run_corpus(state, Mode::Colored, write_string_corpus);
+}
+
+BENCH(corpus_wide_compact)
+{
+  run_corpus(state, Mode::Compact, write_wide_corpus);
+}
+
+BENCH(corpus_wide_pretty)
+{
+  run_corpus(state, Mode::Pretty, write_wide_corpus);
+}
+
+BENCH(corpus_wide_colored)
+{
+  run_corpus(state, Mode::Colored, write_wide_corpus);
+}
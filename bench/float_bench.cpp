@@ -0,0 +1,124 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+#include "corpus.hpp"
+
+#include "json_writer.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <limits>
+#include <string>
+
+namespace {
+// The formatting path write_float used before formatting in place, kept as a
+// baseline.
+void
+append_float_to_chars(std::string& buffer, double value)
+{
+  char digits[32];
+  auto [ptr, ec] = std::to_chars(digits, digits + sizeof(digits) - 1, value);
+  *ptr = '\0';
+  buffer.append(digits);
+}
+
+void
+append_float_printf(std::string& buffer, double value, int precision)
+{
+  char digits[512];
+  std::snprintf(digits, sizeof(digits), "%.*f", precision, value);
+  buffer.append(digits);
+}
+} // namespace
+
+BENCH(float_shortest)
+{
+  const Corpus& corpus = get_corpus();
+  while (state.keep_running()) {
+    CompactJsonWriter writer;
+    for (double value : corpus.floats)
+      writer.write_float(value);
+    state.set_bytes_per_iteration(writer.get_buffer().size());
+    do_not_optimize(writer.get_buffer().data());
+  }
+}
+
+BENCH(float_shortest_to_chars_copy)
+{
+  const Corpus& corpus = get_corpus();
+  while (state.keep_running()) {
+    std::string buffer;
+    for (double value : corpus.floats)
+      append_float_to_chars(buffer, value);
+    state.set_bytes_per_iteration(buffer.size());
+    do_not_optimize(buffer.data());
+  }
+}
+
+BENCH(float_fixed_2)
+{
+  const Corpus& corpus = get_corpus();
+  while (state.keep_running()) {
+    CompactJsonWriter writer;
+    for (double value : corpus.floats)
+      writer.write_float(value, 2);
+    state.set_bytes_per_iteration(writer.get_buffer().size());
+    do_not_optimize(writer.get_buffer().data());
+  }
+}
+
+BENCH(float_fixed_2_printf)
+{
+  const Corpus& corpus = get_corpus();
+  while (state.keep_running()) {
+    std::string buffer;
+    for (double value : corpus.floats)
+      append_float_printf(buffer, value, 2);
+    state.set_bytes_per_iteration(buffer.size());
+    do_not_optimize(buffer.data());
+  }
+}
+
+// Telemetry-like records: mostly durations and gauges.
+BENCH(float_telemetry_records)
+{
+  const Corpus& corpus = get_corpus();
+  while (state.keep_running()) {
+    CompactJsonWriter writer;
+    writer.begin_array();
+    for (const LogRecord& record : corpus.log_records) {
+      writer.begin_array_item();
+      writer.begin_object();
+      writer.write_integer_field("timestamp", record.timestamp);
+      writer.write_float_field("duration_ms", record.duration_ms);
+      writer.write_float_field("cpu", record.duration_ms / 250.0, 3);
+      writer.write_float_field("memory_mb", record.duration_ms * 12.5, 1);
+      writer.end_object();
+      writer.end_array_item();
+    }
+    writer.end_array();
+    state.set_bytes_per_iteration(writer.get_buffer().size());
+    do_not_optimize(writer.get_buffer().data());
+  }
+}
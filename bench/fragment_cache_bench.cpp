@@ -0,0 +1,134 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+
+#include "json_writer.hpp"
+
+#include <string>
+#include <vector>
+
+namespace {
+struct Profile
+{
+  uint64_t id;
+  uint64_t version;
+  std::string name;
+  std::string email;
+  std::vector<double> scores;
+};
+
+const std::vector<Profile>&
+get_profiles()
+{
+  static const std::vector<Profile> profiles = [] {
+    std::vector<Profile> list;
+    for (uint64_t id = 0; id < 100; ++id) {
+      Profile profile{ id, 1, "user " + std::to_string(id), "user" + std::to_string(id) + "@example.com", {} };
+      for (int i = 0; i < 20; ++i)
+        profile.scores.push_back(id * 0.37 + i * 1.25);
+      list.push_back(std::move(profile));
+    }
+    return list;
+  }();
+  return profiles;
+}
+
+template<class Writer>
+void
+write_profile(Writer& writer, const Profile& profile)
+{
+  writer.begin_object();
+  writer.write_integer_field("id", profile.id);
+  writer.write_string_field("name", profile.name);
+  writer.write_string_field("email", profile.email);
+  writer.write_bool_field("active", profile.id % 3 != 0);
+  writer.begin_field("scores");
+  writer.write_array(profile.scores.begin(), profile.scores.end(), [](Writer& w, double score) {
+    w.write_float(score);
+  });
+  writer.end_field();
+  writer.end_object();
+}
+
+// A response listing every profile, rendered from scratch or with the
+// profiles taken from the cache.
+template<class Writer>
+void
+write_response(Writer& writer, JsonFragmentCache* cache)
+{
+  writer.begin_object();
+  writer.write_string_field("status", "ok");
+  writer.begin_field("users");
+  writer.begin_array();
+  for (const Profile& profile : get_profiles()) {
+    writer.begin_array_item();
+    if (cache != nullptr) {
+      cache->write(writer, profile.id, profile.version, [&](CompactJsonWriter& fragment_writer) {
+        write_profile(fragment_writer, profile);
+      });
+    } else {
+      write_profile(writer, profile);
+    }
+    writer.end_array_item();
+  }
+  writer.end_array();
+  writer.end_field();
+  writer.end_object();
+}
+
+void
+run_response(BenchState& state, bool pretty, bool cached)
+{
+  JsonFragmentCache cache;
+  JsonWriter writer;
+  writer.set_use_colors(false);
+  writer.set_pretty(pretty);
+  write_response(writer, &cache);
+  state.set_bytes_per_iteration(writer.get_buffer().size());
+  while (state.keep_running()) {
+    writer.reset();
+    write_response(writer, cached ? &cache : nullptr);
+    do_not_optimize(writer.get_buffer().data());
+  }
+}
+} // namespace
+
+BENCH(fragment_cache_compact_regenerated)
+{
+  run_response(state, false, false);
+}
+
+BENCH(fragment_cache_compact_cached)
+{
+  run_response(state, false, true);
+}
+
+BENCH(fragment_cache_pretty_regenerated)
+{
+  run_response(state, true, false);
+}
+
+BENCH(fragment_cache_pretty_cached)
+{
+  run_response(state, true, true);
+}
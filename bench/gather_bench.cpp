@@ -0,0 +1,89 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+
+#include "json_writer.hpp"
+
+#ifdef JSON_WRITER_HAS_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+// Documents embedding large cached fragments, written to /dev/null.
+const std::vector<std::string>&
+get_blobs()
+{
+  static const std::vector<std::string> blobs = [] {
+    std::vector<std::string> blobs;
+    for (int i = 0; i < 64; ++i) {
+      std::string blob;
+      while (blob.size() < 16 * 1024)
+        blob += "<div class='item'><span>cached fragment " + std::to_string(i) + "</span></div>";
+      blobs.push_back(std::move(blob));
+    }
+    return blobs;
+  }();
+  return blobs;
+}
+
+void
+run_blobs(BenchState& state, bool gather_mode)
+{
+  const std::vector<std::string>& blobs = get_blobs();
+  const int fd = open("/dev/null", O_WRONLY);
+  CompactJsonWriter writer;
+  writer.set_gather_mode(gather_mode);
+  while (state.keep_running()) {
+    writer.reset();
+    writer.begin_array();
+    for (const std::string& blob : blobs) {
+      writer.begin_array_item();
+      writer.begin_object();
+      writer.write_integer_field("size", blob.size());
+      writer.begin_field("html");
+      writer.write_string_ref(blob);
+      writer.end_field();
+      writer.end_object();
+      writer.end_array_item();
+    }
+    writer.end_array();
+    writer.write_segments(fd);
+    state.set_bytes_per_iteration(writer.get_output_size());
+  }
+  close(fd);
+}
+} // namespace
+
+BENCH(gather_blobs_copy)
+{
+  run_blobs(state, false);
+}
+
+BENCH(gather_blobs_writev)
+{
+  run_blobs(state, true);
+}
+#endif
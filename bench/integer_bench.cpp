@@ -0,0 +1,127 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+#include "corpus.hpp"
+
+#include "json_writer.hpp"
+
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+// The formatting path write_integer used before the digit-pair formatter,
+// kept as a baseline.
+template<class T>
+void
+append_integer_to_chars(std::string& buffer, T value)
+{
+  constexpr size_t BUFFER_SIZE = std::numeric_limits<T>::digits10 + 1 + std::is_signed<T>::value;
+  char digits[BUFFER_SIZE + 1];
+  auto [ptr, ec] = std::to_chars(digits, digits + BUFFER_SIZE, value);
+  *ptr = '\0';
+  buffer.append(digits);
+}
+
+std::vector<int64_t>
+make_values(int64_t base, uint64_t spread)
+{
+  std::vector<int64_t> values;
+  uint64_t state = 0x9E3779B97F4A7C15ULL;
+  for (int i = 0; i < 10000; ++i) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    values.push_back(base + static_cast<int64_t>((state >> 33) % spread));
+  }
+  return values;
+}
+
+const std::vector<int64_t>&
+get_counters()
+{
+  static const std::vector<int64_t> values = make_values(0, 1000);
+  return values;
+}
+
+const std::vector<int64_t>&
+get_timestamps()
+{
+  static const std::vector<int64_t> values = make_values(1686564942000, 1000000000);
+  return values;
+}
+
+void
+run_write_integer(BenchState& state, const std::vector<int64_t>& values)
+{
+  while (state.keep_running()) {
+    CompactJsonWriter writer;
+    for (int64_t value : values)
+      writer.write_integer(value);
+    state.set_bytes_per_iteration(writer.get_buffer().size());
+    do_not_optimize(writer.get_buffer().data());
+  }
+}
+
+void
+run_to_chars(BenchState& state, const std::vector<int64_t>& values)
+{
+  while (state.keep_running()) {
+    std::string buffer;
+    for (int64_t value : values)
+      append_integer_to_chars(buffer, value);
+    state.set_bytes_per_iteration(buffer.size());
+    do_not_optimize(buffer.data());
+  }
+}
+} // namespace
+
+BENCH(integer_counters)
+{
+  run_write_integer(state, get_counters());
+}
+
+BENCH(integer_counters_to_chars)
+{
+  run_to_chars(state, get_counters());
+}
+
+BENCH(integer_timestamps)
+{
+  run_write_integer(state, get_timestamps());
+}
+
+BENCH(integer_timestamps_to_chars)
+{
+  run_to_chars(state, get_timestamps());
+}
+
+BENCH(integer_random)
+{
+  run_write_integer(state, get_corpus().integers);
+}
+
+BENCH(integer_random_to_chars)
+{
+  run_to_chars(state, get_corpus().integers);
+}
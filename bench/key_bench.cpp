@@ -0,0 +1,91 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+#include "corpus.hpp"
+
+#include "json_writer.hpp"
+
+#include <string>
+#include <vector>
+
+namespace {
+// A log schema with 30 fixed fields per record.
+constexpr int FIELD_COUNT = 30;
+
+const std::vector<std::string>&
+get_field_names()
+{
+  static const std::vector<std::string> names = [] {
+    std::vector<std::string> names;
+    for (int i = 0; i < FIELD_COUNT; ++i)
+      names.push_back("field_name_" + std::to_string(i));
+    return names;
+  }();
+  return names;
+}
+
+const std::vector<JsonKey>&
+get_field_keys()
+{
+  static const std::vector<JsonKey> keys = [] {
+    std::vector<JsonKey> keys;
+    for (const std::string& name : get_field_names())
+      keys.emplace_back(name);
+    return keys;
+  }();
+  return keys;
+}
+
+template<class Names>
+void
+run_fields(BenchState& state, const Names& names)
+{
+  const Corpus& corpus = get_corpus();
+  CompactJsonWriter writer;
+  while (state.keep_running()) {
+    writer.reset();
+    writer.begin_array();
+    for (const LogRecord& record : corpus.log_records) {
+      writer.begin_array_item();
+      writer.begin_object();
+      for (int i = 0; i < FIELD_COUNT; ++i)
+        writer.write_integer_field(names[i], record.thread_id);
+      writer.end_object();
+      writer.end_array_item();
+    }
+    writer.end_array();
+    state.set_bytes_per_iteration(writer.get_buffer().size());
+    do_not_optimize(writer.get_buffer().data());
+  }
+}
+} // namespace
+
+BENCH(fields_string_names)
+{
+  run_fields(state, get_field_names());
+}
+
+BENCH(fields_json_keys)
+{
+  run_fields(state, get_field_keys());
+}
@@ -0,0 +1,132 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+#include "corpus.hpp"
+
+#include "json_writer.hpp"
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+// Each iteration writes RECORD_COUNT log records split between the producer
+// threads, either into one writer guarded by a mutex or through the lock-free
+// log stream. The output is discarded.
+constexpr int RECORD_COUNT = 4096;
+
+class NullSink : public JsonSink
+{
+public:
+  void write(const char* data, size_t size) override { do_not_optimize(data[size - 1]); }
+};
+
+void
+write_log_record(CompactJsonWriter& writer, const LogRecord& record)
+{
+  writer.begin_object();
+  writer.write_integer_field("timestamp", record.timestamp);
+  writer.write_string_field("level", record.level);
+  writer.write_string_field("logger", record.logger);
+  writer.write_string_field("message", record.message);
+  writer.write_integer_field("thread_id", record.thread_id);
+  writer.end_object();
+}
+
+size_t
+get_output_size()
+{
+  const std::vector<LogRecord>& records = get_corpus().log_records;
+  CompactJsonWriter writer;
+  for (int i = 0; i < RECORD_COUNT; ++i) {
+    writer.begin_record();
+    write_log_record(writer, records[i % records.size()]);
+    writer.end_record();
+  }
+  return writer.get_buffer().size();
+}
+
+template<class F>
+void
+run_producers(int thread_count, F produce)
+{
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < thread_count; ++thread)
+    threads.emplace_back(produce, thread);
+  for (std::thread& thread : threads)
+    thread.join();
+}
+
+void
+run_mutex(BenchState& state, int thread_count)
+{
+  const std::vector<LogRecord>& records = get_corpus().log_records;
+  NullSink sink;
+  CompactJsonWriter writer;
+  writer.set_sink(&sink);
+  std::mutex mutex;
+  while (state.keep_running()) {
+    run_producers(thread_count, [&](int thread) {
+      for (int i = thread; i < RECORD_COUNT; i += thread_count) {
+        std::lock_guard<std::mutex> lock(mutex);
+        writer.begin_record();
+        write_log_record(writer, records[i % records.size()]);
+        writer.end_record();
+      }
+    });
+  }
+  writer.flush();
+  state.set_bytes_per_iteration(get_output_size());
+}
+
+void
+run_log_stream(BenchState& state, int thread_count)
+{
+  const std::vector<LogRecord>& records = get_corpus().log_records;
+  NullSink sink;
+  JsonLogStream stream(sink);
+  while (state.keep_running()) {
+    run_producers(thread_count, [&](int thread) {
+      for (int i = thread; i < RECORD_COUNT; i += thread_count)
+        stream.write([&](CompactJsonWriter& writer) { write_log_record(writer, records[i % records.size()]); });
+    });
+  }
+  stream.close();
+  state.set_bytes_per_iteration(get_output_size());
+}
+} // namespace
+
+#define LOG_STREAM_BENCH(thread_count)                                                                                 \
+  BENCH(log_stream_mutex_##thread_count)                                                                               \
+  {                                                                                                                    \
+    run_mutex(state, thread_count);                                                                                    \
+  }                                                                                                                    \
+  BENCH(log_stream_ring_##thread_count)                                                                                \
+  {                                                                                                                    \
+    run_log_stream(state, thread_count);                                                                               \
+  }
+
+LOG_STREAM_BENCH(1)
+LOG_STREAM_BENCH(4)
+LOG_STREAM_BENCH(16)
+LOG_STREAM_BENCH(64)
@@ -0,0 +1,210 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace {
+std::atomic<uint64_t> g_allocation_count{ 0 };
+
+void*
+counted_allocate(size_t size)
+{
+  g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size != 0 ? size : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+// Used by std::pmr::new_delete_resource(), and so by the heap-backed arenas.
+void*
+counted_allocate(size_t size, std::align_val_t alignment)
+{
+  g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  const size_t align = static_cast<size_t>(alignment);
+  // The size must be a multiple of the alignment.
+  size = (std::max<size_t>(size, 1) + align - 1) / align * align;
+#ifdef _WIN32
+  void* ptr = _aligned_malloc(size, align);
+#else
+  void* ptr = std::aligned_alloc(align, size);
+#endif
+  if (ptr != nullptr)
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void
+aligned_free(void* ptr)
+{
+#ifdef _WIN32
+  _aligned_free(ptr);
+#else
+  std::free(ptr);
+#endif
+}
+} // namespace
+
+void*
+operator new(size_t size)
+{
+  return counted_allocate(size);
+}
+
+void*
+operator new[](size_t size)
+{
+  return counted_allocate(size);
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void
+operator delete[](void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void
+operator delete(void* ptr, size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void
+operator delete[](void* ptr, size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void*
+operator new(size_t size, std::align_val_t alignment)
+{
+  return counted_allocate(size, alignment);
+}
+
+void*
+operator new[](size_t size, std::align_val_t alignment)
+{
+  return counted_allocate(size, alignment);
+}
+
+void
+operator delete(void* ptr, std::align_val_t) noexcept
+{
+  aligned_free(ptr);
+}
+
+void
+operator delete[](void* ptr, std::align_val_t) noexcept
+{
+  aligned_free(ptr);
+}
+
+void
+operator delete(void* ptr, size_t, std::align_val_t) noexcept
+{
+  aligned_free(ptr);
+}
+
+void
+operator delete[](void* ptr, size_t, std::align_val_t) noexcept
+{
+  aligned_free(ptr);
+}
+
+uint64_t
+get_allocation_count()
+{
+  return g_allocation_count.load(std::memory_order_relaxed);
+}
+
+namespace {
+struct BenchCase
+{
+  const char* name;
+  BenchFunc func;
+};
+
+std::vector<BenchCase>&
+get_registry()
+{
+  static std::vector<BenchCase> registry;
+  return registry;
+}
+} // namespace
+
+BenchRegistrar::BenchRegistrar(const char* name, BenchFunc func)
+{
+  get_registry().push_back({ name, func });
+}
+
+// Usage: json_writer_bench [--min-time=SECONDS] [FILTER]
+// Only the benchmarks whose name contains FILTER are run.
+int
+main(int argc, char* argv[])
+{
+  double min_time = 0.5;
+  const char* filter = nullptr;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strncmp(argv[i], "--min-time=", 11) == 0)
+      min_time = std::atof(argv[i] + 11);
+    else
+      filter = argv[i];
+  }
+
+  const auto min_duration =
+    std::chrono::duration_cast<BenchState::Clock::duration>(std::chrono::duration<double>(min_time));
+
+  std::printf("%-44s %12s %12s %10s %10s\n", "benchmark", "iterations", "ns/op", "MB/s", "allocs/op");
+  for (const BenchCase& bench : get_registry()) {
+    if (filter != nullptr && std::strstr(bench.name, filter) == nullptr)
+      continue;
+
+    BenchState state(min_duration);
+    bench.func(state);
+
+    const double seconds = std::chrono::duration<double>(state.get_elapsed()).count();
+    const double iterations = static_cast<double>(state.get_iterations());
+    const double ns_per_op = seconds * 1e9 / iterations;
+    const double mb_per_s = static_cast<double>(state.get_bytes_per_iteration()) * iterations / seconds / 1e6;
+    const double allocations_per_op = static_cast<double>(state.get_allocations()) / iterations;
+    std::printf(
+      "%-44s %12.0f %12.1f %10.1f %10.2f\n", bench.name, iterations, ns_per_op, mb_per_s, allocations_per_op);
+  }
+}
@@ -0,0 +1,75 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+#include "corpus.hpp"
+
+#include "json_writer.hpp"
+
+namespace {
+// Log records repeated copies times in an array, serialized by a fresh writer
+// at each iteration, either growing its buffer or reserving the measured size.
+void
+run_log_records(BenchState& state, int copies, bool measure)
+{
+  const auto write = [copies](CompactJsonWriter& writer) {
+    writer.begin_array();
+    for (int i = 0; i < copies; ++i) {
+      writer.begin_array_item();
+      write_log_records(writer, get_corpus().log_records);
+      writer.end_array_item();
+    }
+    writer.end_array();
+  };
+
+  size_t size = 0;
+  while (state.keep_running()) {
+    CompactJsonWriter writer;
+    if (measure)
+      writer.reserve(writer.measure(write));
+    write(writer);
+    size = writer.get_buffer().size();
+    do_not_optimize(writer.get_buffer().data());
+  }
+  state.set_bytes_per_iteration(size);
+}
+} // namespace
+
+BENCH(measure_log_records_grow)
+{
+  run_log_records(state, 1, false);
+}
+
+BENCH(measure_log_records_reserve)
+{
+  run_log_records(state, 1, true);
+}
+
+BENCH(measure_large_log_records_grow)
+{
+  run_log_records(state, 64, false);
+}
+
+BENCH(measure_large_log_records_reserve)
+{
+  run_log_records(state, 64, true);
+}
@@ -0,0 +1,106 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+
+#include "corpus.hpp"
+#include "json_writer.hpp"
+
+#ifdef JSON_WRITER_HAS_POSIX
+#include <cstdlib>
+#include <unistd.h>
+
+namespace {
+// Writes an array of 64 copies of the log records to a temporary file.
+template<class Writer>
+void
+write_log_records_array(Writer& writer, const Corpus& corpus)
+{
+  writer.begin_array();
+  for (int i = 0; i < 64; ++i) {
+    writer.begin_array_item();
+    write_log_records(writer, corpus.log_records);
+    writer.end_array_item();
+  }
+  writer.end_array();
+}
+
+int
+make_temporary_file()
+{
+  char path[] = "/tmp/json_writer_bench_XXXXXX";
+  const int fd = mkstemp(path);
+  if (fd >= 0)
+    unlink(path);
+  return fd;
+}
+
+void
+set_log_records_bytes(BenchState& state, const Corpus& corpus)
+{
+  CompactJsonWriter size_writer;
+  write_log_records(size_writer, corpus.log_records);
+  state.set_bytes_per_iteration(64 * (size_writer.get_buffer().size() + 1) + 1);
+}
+} // namespace
+
+BENCH(sink_file_fd)
+{
+  const Corpus& corpus = get_corpus();
+  const int fd = make_temporary_file();
+  if (fd < 0)
+    return;
+
+  CompactJsonWriter writer;
+  while (state.keep_running()) {
+    if (ftruncate(fd, 0) != 0 || lseek(fd, 0, SEEK_SET) != 0)
+      break;
+    JsonFdSink sink(fd);
+    writer.reset();
+    writer.set_sink(&sink);
+    write_log_records_array(writer, corpus);
+    writer.flush();
+  }
+  writer.set_sink(nullptr);
+
+  set_log_records_bytes(state, corpus);
+  close(fd);
+}
+
+BENCH(mmap_file)
+{
+  const Corpus& corpus = get_corpus();
+  const int fd = make_temporary_file();
+  if (fd < 0)
+    return;
+
+  while (state.keep_running()) {
+    MmapCompactJsonWriter writer(JsonMmapFile{ fd });
+    write_log_records_array(writer, corpus);
+    if (!writer.take_buffer().close())
+      break;
+  }
+
+  set_log_records_bytes(state, corpus);
+  close(fd);
+}
+#endif
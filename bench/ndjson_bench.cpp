@@ -0,0 +1,91 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+
+#include "corpus.hpp"
+#include "json_writer.hpp"
+
+#include <string>
+
+namespace {
+class NullSink : public JsonSink
+{
+public:
+  void write(const char* data, size_t size) override { do_not_optimize(data[size - 1]); }
+};
+
+template<class Writer>
+void
+write_log_record(Writer& writer, const LogRecord& record)
+{
+  writer.begin_object();
+  writer.write_integer_field("timestamp", record.timestamp);
+  writer.write_string_field("level", record.level);
+  writer.write_string_field("message", record.message);
+  writer.end_object();
+}
+} // namespace
+
+// One writer per record, copied into the batch with a newline.
+BENCH(ndjson_log_records_copy)
+{
+  const std::vector<LogRecord>& records = get_corpus().log_records;
+  std::string batch;
+  size_t size = 0;
+  while (state.keep_running()) {
+    batch.clear();
+    for (const LogRecord& record : records) {
+      CompactJsonWriter writer;
+      write_log_record(writer, record);
+      batch += writer.get_buffer();
+      batch += '\n';
+    }
+    size = batch.size();
+    do_not_optimize(batch);
+  }
+  state.set_bytes_per_iteration(size);
+}
+
+BENCH(ndjson_log_records_batch)
+{
+  const std::vector<LogRecord>& records = get_corpus().log_records;
+  NullSink sink;
+  CompactJsonWriter writer;
+  writer.set_sink(&sink);
+  while (state.keep_running()) {
+    for (const LogRecord& record : records) {
+      writer.begin_record();
+      write_log_record(writer, record);
+      writer.end_record();
+    }
+  }
+  writer.flush();
+
+  CompactJsonWriter size_writer;
+  for (const LogRecord& record : records) {
+    size_writer.begin_record();
+    write_log_record(size_writer, record);
+    size_writer.end_record();
+  }
+  state.set_bytes_per_iteration(size_writer.get_buffer().size());
+}
@@ -0,0 +1,96 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+#include "corpus.hpp"
+
+#include "json_writer.hpp"
+
+#include <vector>
+
+namespace {
+template<class T>
+void
+run_per_item(BenchState& state, const std::vector<T>& values, bool pretty)
+{
+  JsonWriter writer;
+  writer.set_pretty(pretty);
+  while (state.keep_running()) {
+    writer.reset();
+    writer.write_array(values.begin(), values.end(), [](JsonWriter& writer, T value) {
+      if constexpr (std::is_integral_v<T>)
+        writer.write_integer(value);
+      else
+        writer.write_float(value);
+    });
+    do_not_optimize(writer.get_buffer().data());
+  }
+  state.set_bytes_per_iteration(writer.get_buffer().size());
+}
+
+template<class T>
+void
+run_bulk(BenchState& state, const std::vector<T>& values, bool pretty)
+{
+  JsonWriter writer;
+  writer.set_pretty(pretty);
+  while (state.keep_running()) {
+    writer.reset();
+    if constexpr (std::is_integral_v<T>)
+      writer.write_integer_array(values);
+    else
+      writer.write_float_array(values);
+    do_not_optimize(writer.get_buffer().data());
+  }
+  state.set_bytes_per_iteration(writer.get_buffer().size());
+}
+} // namespace
+
+BENCH(number_array_integers_per_item)
+{
+  run_per_item(state, get_corpus().integers, false);
+}
+
+BENCH(number_array_integers_bulk)
+{
+  run_bulk(state, get_corpus().integers, false);
+}
+
+BENCH(number_array_integers_pretty_per_item)
+{
+  run_per_item(state, get_corpus().integers, true);
+}
+
+BENCH(number_array_integers_pretty_bulk)
+{
+  run_bulk(state, get_corpus().integers, true);
+}
+
+BENCH(number_array_floats_per_item)
+{
+  run_per_item(state, get_corpus().floats, false);
+}
+
+BENCH(number_array_floats_bulk)
+{
+  run_bulk(state, get_corpus().floats, false);
+}
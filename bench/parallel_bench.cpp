@@ -0,0 +1,109 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+#include "corpus.hpp"
+
+#include "json_writer.hpp"
+
+#include <vector>
+
+namespace {
+// 10^5 log records, built by repeating the corpus.
+const std::vector<LogRecord>&
+get_records()
+{
+  static const std::vector<LogRecord> records = [] {
+    std::vector<LogRecord> records;
+    while (records.size() < 100000) {
+      const std::vector<LogRecord>& source = get_corpus().log_records;
+      records.insert(records.end(), source.begin(), source.end());
+    }
+    return records;
+  }();
+  return records;
+}
+
+void
+write_record(CompactJsonWriter& writer, const LogRecord& record)
+{
+  writer.begin_object();
+  writer.write_integer_field("timestamp", record.timestamp);
+  writer.write_string_field("level", record.level);
+  writer.write_string_field("logger", record.logger);
+  writer.write_string_field("message", record.message);
+  writer.write_integer_field("thread_id", record.thread_id);
+  writer.write_float_field("duration_ms", record.duration_ms);
+  writer.write_bool_field("success", record.success);
+  writer.end_object();
+}
+
+void
+run_parallel(BenchState& state, unsigned thread_count)
+{
+  const std::vector<LogRecord>& records = get_records();
+  while (state.keep_running()) {
+    CompactJsonWriter writer;
+    if (thread_count == 0)
+      writer.write_array(records.begin(), records.end(), write_record);
+    else
+      writer.write_array_parallel(records.begin(), records.end(), write_record, thread_count);
+    state.set_bytes_per_iteration(writer.get_buffer().size());
+    do_not_optimize(writer.get_buffer().data());
+  }
+}
+} // namespace
+
+BENCH(parallel_array_sequential)
+{
+  run_parallel(state, 0);
+}
+
+BENCH(parallel_array_1_thread)
+{
+  run_parallel(state, 1);
+}
+
+BENCH(parallel_array_2_threads)
+{
+  run_parallel(state, 2);
+}
+
+BENCH(parallel_array_4_threads)
+{
+  run_parallel(state, 4);
+}
+
+BENCH(parallel_array_8_threads)
+{
+  run_parallel(state, 8);
+}
+
+BENCH(parallel_array_16_threads)
+{
+  run_parallel(state, 16);
+}
+
+BENCH(parallel_array_32_threads)
+{
+  run_parallel(state, 32);
+}
@@ -0,0 +1,79 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+#include "corpus.hpp"
+
+#include "json_writer.hpp"
+
+#include <string>
+
+// Repeated documents of the same size: a fresh writer per document versus
+// reused buffers, which should reach zero allocations per document.
+
+BENCH(reuse_fresh_writer)
+{
+  const Corpus& corpus = get_corpus();
+  while (state.keep_running()) {
+    CompactJsonWriter writer;
+    write_log_records(writer, corpus.log_records);
+    state.set_bytes_per_iteration(writer.get_buffer().size());
+    do_not_optimize(writer.get_buffer().data());
+  }
+}
+
+BENCH(reuse_reset)
+{
+  const Corpus& corpus = get_corpus();
+  CompactJsonWriter writer;
+  while (state.keep_running()) {
+    writer.reset();
+    write_log_records(writer, corpus.log_records);
+    state.set_bytes_per_iteration(writer.get_buffer().size());
+    do_not_optimize(writer.get_buffer().data());
+  }
+}
+
+BENCH(reuse_swap_buffer)
+{
+  const Corpus& corpus = get_corpus();
+  CompactJsonWriter writer;
+  std::string output;
+  while (state.keep_running()) {
+    write_log_records(writer, corpus.log_records);
+    // The consumer gets the output and gives back the previous buffer.
+    writer.swap_buffer(output);
+    state.set_bytes_per_iteration(output.size());
+    do_not_optimize(output.data());
+  }
+}
+
+BENCH(reuse_pool)
+{
+  const Corpus& corpus = get_corpus();
+  while (state.keep_running()) {
+    auto writer = JsonWriterPool<CompactJsonWriter>::acquire();
+    write_log_records(*writer, corpus.log_records);
+    state.set_bytes_per_iteration(writer->get_buffer().size());
+    do_not_optimize(writer->get_buffer().data());
+  }
+}
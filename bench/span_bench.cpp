@@ -0,0 +1,90 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+#include "corpus.hpp"
+
+#include "json_writer.hpp"
+
+#include <vector>
+
+namespace {
+// Small messages, as built on a packet hot path: one log record per message.
+template<class Writer>
+void
+write_message(Writer& writer, const LogRecord& record)
+{
+  writer.begin_object();
+  writer.write_integer_field("timestamp", record.timestamp);
+  writer.write_string_field("level", record.level);
+  writer.write_string_field("logger", record.logger);
+  writer.write_string_field("message", record.message);
+  writer.write_integer_field("thread_id", record.thread_id);
+  writer.end_object();
+}
+
+template<class F>
+void
+run_messages(BenchState& state, F write)
+{
+  const std::vector<LogRecord>& records = get_corpus().log_records;
+  size_t index = 0;
+  size_t size = 0;
+  while (state.keep_running()) {
+    size = write(records[index]);
+    index = index + 1 == records.size() ? 0 : index + 1;
+  }
+  state.set_bytes_per_iteration(size);
+}
+} // namespace
+
+BENCH(span_message_fresh_writer)
+{
+  run_messages(state, [](const LogRecord& record) {
+    CompactJsonWriter writer;
+    write_message(writer, record);
+    do_not_optimize(writer.get_buffer().data());
+    return writer.get_buffer().size();
+  });
+}
+
+BENCH(span_message_reused_writer)
+{
+  CompactJsonWriter writer;
+  run_messages(state, [&](const LogRecord& record) {
+    writer.reset();
+    write_message(writer, record);
+    do_not_optimize(writer.get_buffer().data());
+    return writer.get_buffer().size();
+  });
+}
+
+BENCH(span_message_stack_span)
+{
+  run_messages(state, [](const LogRecord& record) {
+    char storage[1024];
+    SpanCompactJsonWriter writer(JsonSpanBuffer{ storage });
+    write_message(writer, record);
+    do_not_optimize(storage);
+    return writer.get_buffer().size();
+  });
+}
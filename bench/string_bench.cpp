@@ -0,0 +1,173 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+
+#include "json_writer.hpp"
+
+#include <string>
+#include <string_view>
+
+namespace {
+constexpr size_t CORPUS_SIZE = 64 * 1024;
+
+std::string
+make_corpus(std::string_view pattern)
+{
+  std::string corpus;
+  corpus.reserve(CORPUS_SIZE + pattern.size());
+  while (corpus.size() < CORPUS_SIZE)
+    corpus.append(pattern);
+  return corpus;
+}
+
+const std::string&
+get_ascii_corpus()
+{
+  static const std::string corpus =
+    make_corpus("2023-06-12T10:15:42Z INFO request handled method=GET path=/api/v1/users/42 status=200 took=3ms ");
+  return corpus;
+}
+
+const std::string&
+get_escaped_corpus()
+{
+  static const std::string corpus = make_corpus("\"a\\b\"\n\"c\\d\"\t");
+  return corpus;
+}
+
+const std::string&
+get_utf8_corpus()
+{
+  static const std::string corpus = make_corpus("\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82 \xe4\xb8\x96\xe7\x95\x8c "
+                                                "\xf0\x9f\x98\x80 caf\xc3\xa9 na\xc3\xaf"
+                                                "ve ");
+  return corpus;
+}
+
+// The byte-per-byte escaping loop the writer used before the vectorized scan,
+// kept as a baseline.
+void
+escape_bytewise(std::string& buffer, std::string_view value)
+{
+  buffer.push_back('"');
+  for (const char ch : value) {
+    switch (ch) {
+      case '"':
+        buffer.append("\\\"");
+        break;
+      case '\\':
+        buffer.append("\\\\");
+        break;
+      case '\n':
+        buffer.append("\\n");
+        break;
+      case '\r':
+        buffer.append("\\r");
+        break;
+      case '\t':
+        buffer.append("\\t");
+        break;
+      case '\f':
+        buffer.append("\\f");
+        break;
+      default:
+        buffer.push_back(ch);
+    }
+  }
+  buffer.push_back('"');
+}
+
+template<JsonEscape Escape = JsonEscape::Default>
+void
+run_write_string(BenchState& state, const std::string& corpus)
+{
+  state.set_bytes_per_iteration(corpus.size());
+  while (state.keep_running()) {
+    BasicJsonWriter<JsonMode::Runtime, JsonMode::Runtime, Escape> writer;
+    writer.set_use_colors(false);
+    writer.write_string(corpus);
+    do_not_optimize(writer.get_buffer().data());
+  }
+}
+
+void
+run_escape_bytewise(BenchState& state, const std::string& corpus)
+{
+  state.set_bytes_per_iteration(corpus.size());
+  while (state.keep_running()) {
+    std::string buffer;
+    escape_bytewise(buffer, corpus);
+    do_not_optimize(buffer.data());
+  }
+}
+} // namespace
+
+BENCH(write_string_ascii)
+{
+  run_write_string(state, get_ascii_corpus());
+}
+
+BENCH(write_string_ascii_bytewise)
+{
+  run_escape_bytewise(state, get_ascii_corpus());
+}
+
+BENCH(write_string_escaped)
+{
+  run_write_string(state, get_escaped_corpus());
+}
+
+BENCH(write_string_escaped_bytewise)
+{
+  run_escape_bytewise(state, get_escaped_corpus());
+}
+
+BENCH(write_string_utf8)
+{
+  run_write_string(state, get_utf8_corpus());
+}
+
+BENCH(write_string_utf8_bytewise)
+{
+  run_escape_bytewise(state, get_utf8_corpus());
+}
+
+BENCH(write_string_ascii_html_controls)
+{
+  run_write_string<JsonEscape::Html | JsonEscape::Controls>(state, get_ascii_corpus());
+}
+
+BENCH(write_string_ascii_validate_utf8)
+{
+  run_write_string<JsonEscape::ReplaceInvalidUtf8>(state, get_ascii_corpus());
+}
+
+BENCH(write_string_utf8_validate_utf8)
+{
+  run_write_string<JsonEscape::ReplaceInvalidUtf8>(state, get_utf8_corpus());
+}
+
+BENCH(write_string_utf8_ascii_only)
+{
+  run_write_string<JsonEscape::Ascii>(state, get_utf8_corpus());
+}
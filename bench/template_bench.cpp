@@ -0,0 +1,131 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+#include "corpus.hpp"
+
+#include "json_writer.hpp"
+
+#include <string>
+#include <vector>
+
+namespace {
+// An API response with a fixed shape: only the values change between
+// documents. Writes the values, or slots if record is null.
+template<class Writer>
+void
+write_response(Writer& writer, const LogRecord* record)
+{
+  writer.begin_object();
+  writer.write_string_field("api_version", "2.1");
+  writer.begin_field("data");
+  writer.begin_object();
+  writer.begin_field("timestamp");
+  record ? writer.write_integer(record->timestamp) : writer.write_slot(JsonSlotKind::Integer);
+  writer.end_field();
+  writer.begin_field("level");
+  record ? writer.write_string(record->level) : writer.write_slot(JsonSlotKind::String);
+  writer.end_field();
+  writer.begin_field("message");
+  record ? writer.write_string(record->message) : writer.write_slot(JsonSlotKind::String);
+  writer.end_field();
+  writer.begin_field("duration_ms");
+  record ? writer.write_float(record->duration_ms) : writer.write_slot(JsonSlotKind::Float);
+  writer.end_field();
+  writer.begin_field("success");
+  record ? writer.write_bool(record->success) : writer.write_slot(JsonSlotKind::Bool);
+  writer.end_field();
+  writer.end_object();
+  writer.end_field();
+  writer.begin_field("meta");
+  writer.begin_object();
+  writer.write_string_field("region", "eu-west-1");
+  writer.write_string_field("service", "audit-log");
+  writer.write_bool_field("cached", false);
+  writer.end_object();
+  writer.end_field();
+  writer.end_object();
+}
+
+void
+run_writer(BenchState& state, bool pretty)
+{
+  const std::vector<LogRecord>& records = get_corpus().log_records;
+  JsonWriter writer;
+  writer.set_pretty(pretty);
+  size_t size = 0;
+  while (state.keep_running()) {
+    for (const LogRecord& record : records) {
+      writer.reset();
+      write_response(writer, &record);
+      size += writer.get_buffer().size();
+    }
+  }
+  state.set_bytes_per_iteration(size / std::max<uint64_t>(state.get_iterations(), 1));
+}
+
+void
+run_template(BenchState& state, bool pretty)
+{
+  const std::vector<LogRecord>& records = get_corpus().log_records;
+  JsonWriter template_writer;
+  template_writer.set_pretty(pretty);
+  write_response(template_writer, nullptr);
+  const JsonTemplate document(template_writer);
+
+  std::string buffer;
+  size_t size = 0;
+  while (state.keep_running()) {
+    for (const LogRecord& record : records) {
+      JsonTemplate::Filler filler = document.fill(std::move(buffer));
+      filler.write_integer(record.timestamp);
+      filler.write_string(record.level);
+      filler.write_string(record.message);
+      filler.write_float(record.duration_ms);
+      filler.write_bool(record.success);
+      buffer = filler.finish();
+      size += buffer.size();
+    }
+  }
+  state.set_bytes_per_iteration(size / std::max<uint64_t>(state.get_iterations(), 1));
+}
+} // namespace
+
+BENCH(template_response_writer)
+{
+  run_writer(state, false);
+}
+
+BENCH(template_response_fill)
+{
+  run_template(state, false);
+}
+
+BENCH(template_response_pretty_writer)
+{
+  run_writer(state, true);
+}
+
+BENCH(template_response_pretty_fill)
+{
+  run_template(state, true);
+}
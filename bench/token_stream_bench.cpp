@@ -0,0 +1,123 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+#include "corpus.hpp"
+
+#include "json_writer.hpp"
+
+namespace {
+// Renders the log records in the compact, pretty and colored forms, either by
+// running the writer calls three times or by replaying recorded tokens.
+void
+configure(JsonWriter& writer, int form)
+{
+  writer.set_pretty(form != 0);
+  writer.set_use_colors(form == 2);
+}
+
+void
+run_regenerate(BenchState& state)
+{
+  const Corpus& corpus = get_corpus();
+  JsonWriter writers[3];
+  for (int form = 0; form < 3; ++form)
+    configure(writers[form], form);
+
+  size_t size = 0;
+  while (state.keep_running()) {
+    size = 0;
+    for (JsonWriter& writer : writers) {
+      writer.reset();
+      write_log_records(writer, corpus.log_records);
+      size += writer.get_buffer().size();
+    }
+  }
+  state.set_bytes_per_iteration(size);
+}
+
+void
+run_replay(BenchState& state)
+{
+  const Corpus& corpus = get_corpus();
+  JsonWriter writers[3];
+  for (int form = 0; form < 3; ++form)
+    configure(writers[form], form);
+
+  JsonTokenStream tokens;
+  size_t size = 0;
+  while (state.keep_running()) {
+    size = 0;
+    tokens.clear();
+    write_log_records(tokens, corpus.log_records);
+    for (JsonWriter& writer : writers) {
+      writer.reset();
+      tokens.replay(writer);
+      size += writer.get_buffer().size();
+    }
+  }
+  state.set_bytes_per_iteration(size);
+}
+
+void
+run_replay_only(BenchState& state)
+{
+  const Corpus& corpus = get_corpus();
+  JsonWriter writer;
+  configure(writer, 1);
+
+  JsonTokenStream tokens;
+  write_log_records(tokens, corpus.log_records);
+  while (state.keep_running()) {
+    writer.reset();
+    tokens.replay(writer);
+  }
+  state.set_bytes_per_iteration(writer.get_buffer().size());
+}
+} // namespace
+
+BENCH(token_stream_three_forms_regenerate)
+{
+  run_regenerate(state);
+}
+
+BENCH(token_stream_three_forms_replay)
+{
+  run_replay(state);
+}
+
+BENCH(token_stream_pretty_regenerate)
+{
+  const Corpus& corpus = get_corpus();
+  JsonWriter writer;
+  configure(writer, 1);
+  while (state.keep_running()) {
+    writer.reset();
+    write_log_records(writer, corpus.log_records);
+  }
+  state.set_bytes_per_iteration(writer.get_buffer().size());
+}
+
+BENCH(token_stream_pretty_replay)
+{
+  run_replay_only(state);
+}
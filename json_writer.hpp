@@ -23,323 +23,4559 @@
 #ifndef JSON_WRITER_HPP
 #define JSON_WRITER_HPP
 
+#include <algorithm>
+#include <atomic>
 #include <charconv>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
 #include <limits>
+#include <memory>
+#if defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#endif
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// Defining JSON_WRITER_ENABLE_STATS (consistently in the whole program) makes
+// the writers collect JsonWriterStats; JSON_WRITER_ENABLE_CYCLE_STATS also
+// measures the cycles spent in each primitive. Without them, the writers are
+// not instrumented at all.
+#if defined(JSON_WRITER_ENABLE_CYCLE_STATS) && !defined(JSON_WRITER_ENABLE_STATS)
+#define JSON_WRITER_ENABLE_STATS
+#endif
+
+#if defined(JSON_WRITER_ENABLE_CYCLE_STATS) && (defined(__GNUC__) || defined(__clang__)) &&                          \
+  (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define JSON_WRITER_HAS_POSIX
+#include <sys/uio.h>
+#endif
+
+namespace json_detail {
+inline bool
+needs_escape(char ch)
+{
+  return ch == '"' || ch == '\\' || static_cast<unsigned char>(ch) < 0x20;
+}
+
+template<class T>
+struct MakeUnsigned
+{
+  using type = std::make_unsigned_t<T>;
+};
+
+#ifdef __SIZEOF_INT128__
+template<>
+struct MakeUnsigned<__int128>
+{
+  using type = unsigned __int128;
+};
+
+template<>
+struct MakeUnsigned<unsigned __int128>
+{
+  using type = unsigned __int128;
+};
+#endif
+
+template<class T>
+constexpr bool
+is_negative(T value)
+{
+  if constexpr (T(-1) < T(0))
+    return value < 0;
+  else
+    return false;
+}
+
+inline constexpr char DIGIT_PAIRS[] = "00010203040506070809"
+                                      "10111213141516171819"
+                                      "20212223242526272829"
+                                      "30313233343536373839"
+                                      "40414243444546474849"
+                                      "50515253545556575859"
+                                      "60616263646566676869"
+                                      "70717273747576777879"
+                                      "80818283848586878889"
+                                      "90919293949596979899";
+
+inline int
+count_leading_zeros(uint64_t value)
+{
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+  unsigned long index;
+  _BitScanReverse64(&index, value);
+  return 63 - static_cast<int>(index);
+#elif defined(__GNUC__) || defined(__clang__)
+  return __builtin_clzll(value);
+#else
+  int count = 0;
+  for (uint64_t bit = uint64_t(1) << 63; (value & bit) == 0; bit >>= 1)
+    ++count;
+  return count;
+#endif
+}
+
+// Reads the timestamp counter (or a nanosecond clock where there is none) when
+// cycle statistics are enabled, and returns 0 otherwise.
+inline uint64_t
+read_cycle_counter()
+{
+#if !defined(JSON_WRITER_ENABLE_CYCLE_STATS)
+  return 0;
+#elif defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+    .count();
+#endif
+}
+
+// Returns the number of decimal digits of value (at least one).
+inline int
+count_digits(uint64_t value)
+{
+  static constexpr uint64_t POWERS_OF_10[] = { 0,
+                                               10ULL,
+                                               100ULL,
+                                               1000ULL,
+                                               10000ULL,
+                                               100000ULL,
+                                               1000000ULL,
+                                               10000000ULL,
+                                               100000000ULL,
+                                               1000000000ULL,
+                                               10000000000ULL,
+                                               100000000000ULL,
+                                               1000000000000ULL,
+                                               10000000000000ULL,
+                                               100000000000000ULL,
+                                               1000000000000000ULL,
+                                               10000000000000000ULL,
+                                               100000000000000000ULL,
+                                               1000000000000000000ULL,
+                                               10000000000000000000ULL };
+  // 1233 / 4096 approximates log10(2), so this is floor(log10(value)) or one
+  // more, corrected by a single comparison.
+  const int approximation = ((64 - count_leading_zeros(value | 1)) * 1233) >> 12;
+  return approximation + 1 - (value < POWERS_OF_10[approximation]);
+}
+
+// Writes the digits of value so that the last one is just before last. The
+// caller must have computed the number of digits with count_digits().
+inline void
+write_digits(char* last, uint64_t value)
+{
+  while (value >= 100) {
+    const size_t index = static_cast<size_t>(value % 100) * 2;
+    value /= 100;
+    last -= 2;
+    last[0] = DIGIT_PAIRS[index];
+    last[1] = DIGIT_PAIRS[index + 1];
+  }
+
+  if (value >= 10) {
+    const size_t index = static_cast<size_t>(value) * 2;
+    last[-2] = DIGIT_PAIRS[index];
+    last[-1] = DIGIT_PAIRS[index + 1];
+  } else {
+    last[-1] = static_cast<char>('0' + value);
+  }
+}
+
+#ifdef __SIZEOF_INT128__
+// 128-bit values are processed in chunks of 19 digits so that the digit loop
+// uses 64-bit divisions.
+constexpr uint64_t POWER_OF_10_19 = 10000000000000000000ULL;
+
+inline int
+count_digits(unsigned __int128 value)
+{
+  int count = 0;
+  while (value > UINT64_MAX) {
+    value /= POWER_OF_10_19;
+    count += 19;
+  }
+  return count + count_digits(static_cast<uint64_t>(value));
+}
+
+inline void
+write_digits(char* last, unsigned __int128 value)
+{
+  while (value > UINT64_MAX) {
+    uint64_t chunk = static_cast<uint64_t>(value % POWER_OF_10_19);
+    value /= POWER_OF_10_19;
+    for (int i = 0; i < 19; ++i) {
+      *--last = static_cast<char>('0' + chunk % 10);
+      chunk /= 10;
+    }
+  }
+  write_digits(last, static_cast<uint64_t>(value));
+}
+#endif
+
+// Returns a pointer to the first character of [begin, end) that may need to be
+// escaped inside a JSON string (a quote, a backslash or a control character),
+// or end if there is none. Uses SSE2/AVX2 when available.
+const char*
+find_escape(const char* begin, const char* end);
+
+// Additional classes of characters for find_escape().
+enum : unsigned
+{
+  FIND_HTML = 1,      // <, > and &
+  FIND_NON_ASCII = 2, // bytes of multibyte UTF-8 sequences
+};
+
+const char*
+find_escape(const char* begin, const char* end, unsigned classes);
+
+// Decodes the UTF-8 sequence starting at it, whose first byte is not ASCII.
+// Returns its size, or 0 if it is invalid (overlong, surrogate, out of range or
+// truncated).
+inline int
+decode_utf8(const char* it, const char* end, uint32_t& code_point)
+{
+  const unsigned char lead = static_cast<unsigned char>(*it);
+  // Range of the second byte, narrower than a continuation byte for some leads.
+  unsigned char min = 0x80;
+  unsigned char max = 0xBF;
+  int size;
+  if (lead >= 0xC2 && lead <= 0xDF) {
+    size = 2;
+    code_point = lead & 0x1F;
+  } else if (lead >= 0xE0 && lead <= 0xEF) {
+    size = 3;
+    code_point = lead & 0x0F;
+    if (lead == 0xE0)
+      min = 0xA0;
+    else if (lead == 0xED)
+      max = 0x9F;
+  } else if (lead >= 0xF0 && lead <= 0xF4) {
+    size = 4;
+    code_point = lead & 0x07;
+    if (lead == 0xF0)
+      min = 0x90;
+    else if (lead == 0xF4)
+      max = 0x8F;
+  } else {
+    return 0;
+  }
+
+  if (end - it < size)
+    return 0;
+
+  for (int i = 1; i < size; ++i) {
+    const unsigned char byte = static_cast<unsigned char>(it[i]);
+    if (byte < min || byte > max)
+      return 0;
+    code_point = (code_point << 6) | (byte & 0x3F);
+    min = 0x80;
+    max = 0xBF;
+  }
+
+  return size;
+}
+
+// Like find_escape() with the given classes (except FIND_NON_ASCII), but skips
+// the valid multibyte UTF-8 sequences: stops at the first character that may
+// need to be escaped or at the first byte of an invalid sequence. The UTF-8
+// validation is vectorized with AVX2 when available.
+const char*
+find_escape_utf8(const char* begin, const char* end, unsigned classes);
+
+// Whether text may be escaped differently by the policies other than the
+// default one, i.e. contains control characters, <, > or & or non-ASCII bytes.
+inline bool
+depends_on_escape_policy(std::string_view text)
+{
+  const char* it = text.data();
+  const char* end = it + text.size();
+  while ((it = find_escape(it, end, FIND_HTML | FIND_NON_ASCII)) != end) {
+    if (*it != '"' && *it != '\\')
+      return true;
+    ++it;
+  }
+  return false;
+}
+
+// Returns the first character of [it, end) that is not JSON whitespace.
+inline const char*
+skip_json_whitespace(const char* it, const char* end)
+{
+  while (it != end && (*it == ' ' || *it == '\n' || *it == '\r' || *it == '\t'))
+    ++it;
+  return it;
+}
+
+// Returns the end of the JSON string starting at it, past its closing quote.
+inline const char*
+find_json_string_end(const char* it, const char* end)
+{
+  ++it;
+  while ((it = find_escape(it, end)) != end) {
+    if (*it == '"')
+      return it + 1;
+    // Skips the escaped character, and a control character as well.
+    it += (*it == '\\' && it + 1 != end) ? 2 : 1;
+  }
+  return end;
+}
+
+// Whether [it, end) has no whitespace outside of its strings.
+inline bool
+is_compact_json(const char* it, const char* end)
+{
+  bool is_in_string = false;
+  for (; it != end; ++it) {
+    const char ch = *it;
+    if (is_in_string) {
+      if (ch == '\\' && it + 1 != end)
+        ++it;
+      else if (ch == '"')
+        is_in_string = false;
+    } else if (ch == '"') {
+      is_in_string = true;
+    } else if (ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t') {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the end of the JSON token starting at it: past the closing quote of a
+// string, or at the next whitespace or structural character otherwise.
+inline const char*
+find_json_token_end(const char* it, const char* end)
+{
+  if (it != end && *it == '"')
+    return find_json_string_end(it, end);
+
+  for (; it != end; ++it) {
+    switch (*it) {
+      case ' ':
+      case '\n':
+      case '\r':
+      case '\t':
+      case ',':
+      case ':':
+      case '[':
+      case ']':
+      case '{':
+      case '}':
+        return it;
+      default:
+        break;
+    }
+  }
+  return it;
+}
+
+// Number of characters of size bytes encoded in base64, with or without the
+// padding.
+constexpr size_t
+base64_size(size_t size, bool padded)
+{
+  return size / 3 * 4 + (size % 3 == 0 ? 0 : padded ? 4 : size % 3 + 1);
+}
+
+// Encodes size bytes in base64 at out, which must have room for base64_size()
+// characters, and returns the end of the output. The standard alphabet is
+// padded, the URL one (- and _ instead of + and /) is not. Uses SSSE3/AVX2 when
+// available.
+char*
+encode_base64(char* out, const unsigned char* data, size_t size, bool url);
+
+#ifdef JSON_WRITER_HAS_POSIX
+// Writes all the given buffers to fd with writev(), resuming after partial
+// writes. Returns false on error, with errno set.
+bool
+write_all(int fd, iovec* vectors, size_t count);
+#endif
+}
+
+// Destination of the output of a JsonWriter, see JsonWriter::set_sink().
+class JsonSink
+{
+public:
+  virtual ~JsonSink() = default;
+
+  virtual void write(const char* data, size_t size) = 0;
+};
+
+// Appends the output to a string.
+class JsonStringSink : public JsonSink
+{
+public:
+  explicit JsonStringSink(std::string& output)
+    : m_output(output)
+  {
+  }
+
+  void write(const char* data, size_t size) override;
+
+private:
+  std::string& m_output;
+};
+
+// Discards the output and only counts its size.
+class JsonCountingSink : public JsonSink
+{
+public:
+  void write(const char* data, size_t size) override;
+
+  size_t get_size() const { return m_size; }
+
+private:
+  size_t m_size = 0;
+};
+
+// Writes the output to a stdio stream. The stream is not closed.
+class JsonFileSink : public JsonSink
+{
+public:
+  explicit JsonFileSink(FILE* file)
+    : m_file(file)
+  {
+  }
+
+  void write(const char* data, size_t size) override;
+
+  bool has_error() const { return m_has_error; }
+
+private:
+  FILE* m_file;
+  bool m_has_error = false;
+};
+
+#ifdef JSON_WRITER_HAS_POSIX
+// Writes the output to a POSIX file descriptor. The descriptor is not closed.
+class JsonFdSink : public JsonSink
+{
+public:
+  explicit JsonFdSink(int fd)
+    : m_fd(fd)
+  {
+  }
+
+  void write(const char* data, size_t size) override;
+
+  bool has_error() const { return m_has_error; }
+
+private:
+  int m_fd;
+  bool m_has_error = false;
+};
+#endif
+
+// Passes each chunk of output to a user callback.
+class JsonCallbackSink : public JsonSink
+{
+public:
+  explicit JsonCallbackSink(std::function<void(std::string_view)> callback)
+    : m_callback(std::move(callback))
+  {
+  }
+
+  void write(const char* data, size_t size) override;
+
+private:
+  std::function<void(std::string_view)> m_callback;
+};
+
+// Writes the output to a stdio stream from a background thread. The output is
+// accumulated in one of buffer_count buffers; when it is full, it is handed to
+// the I/O thread and the producer continues in the next free buffer. The
+// producer only blocks when all the buffers are waiting to be written. The
+// stream is not closed.
+class JsonAsyncFileSink : public JsonSink
+{
+public:
+  struct Stats
+  {
+    // Bytes and buffers written to the stream so far.
+    uint64_t bytes_written = 0;
+    uint64_t buffers_written = 0;
+    // Number of times the producer had to wait for a free buffer.
+    uint64_t producer_waits = 0;
+  };
+
+  static constexpr size_t DEFAULT_BUFFER_COUNT = 2;
+  static constexpr size_t DEFAULT_BUFFER_SIZE = 1024 * 1024;
+
+  explicit JsonAsyncFileSink(FILE* file,
+                             size_t buffer_count = DEFAULT_BUFFER_COUNT,
+                             size_t buffer_size = DEFAULT_BUFFER_SIZE);
+  JsonAsyncFileSink(const JsonAsyncFileSink&) = delete;
+  JsonAsyncFileSink& operator=(const JsonAsyncFileSink&) = delete;
+  // Calls close().
+  ~JsonAsyncFileSink() override;
+
+  void write(const char* data, size_t size) override;
+
+  // Blocks until everything written so far has reached the stream, then
+  // flushes the stream.
+  void flush();
+  // Flushes and stops the I/O thread. Nothing may be written afterwards.
+  void close();
+
+  Stats get_stats() const;
+  bool has_error() const;
+
+private:
+  void submit_current_buffer();
+  void run();
+
+  FILE* m_file;
+  size_t m_buffer_size;
+  // Buffer being filled by the producer, only accessed by the producer.
+  std::string m_current_buffer;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_producer_condition;
+  std::condition_variable m_writer_condition;
+  std::vector<std::string> m_free_buffers;
+  std::deque<std::string> m_pending_buffers;
+  size_t m_writing_count = 0;
+  Stats m_stats;
+  bool m_has_error = false;
+  bool m_stopping = false;
+  std::thread m_thread;
+};
+
+// SGR color codes used when colors are enabled.
+struct JsonColors
+{
+  const char* field = "36";
+  const char* string = "32";
+  const char* boolean = "31";
+  const char* null = "35";
+  const char* number = "33";
+};
+
+// Field name escaped and quoted once, to be reused for many fields. Passing it
+// to begin_field() or to the write_*_field() functions reduces writing the name
+// to a single copy of its precomputed form, typically from a static:
+//   static const JsonKey NAME_KEY("name");
+//   writer.write_string_field(NAME_KEY, name);
+// Writers with another escape policy than the default one escape the name again
+// if the policy may change it.
+class JsonKey
+{
+public:
+  explicit JsonKey(std::string_view name);
+
+  // The escaped name with its quotes and the colon, e.g. "name":
+  std::string_view get_quoted() const { return m_quoted; }
+  // The name as given, kept only if depends_on_escape_policy().
+  std::string_view get_name() const { return m_name; }
+  bool depends_on_escape_policy() const { return m_depends_on_escape_policy; }
+
+private:
+  std::string m_quoted;
+  std::string m_name;
+  bool m_depends_on_escape_policy;
+};
+
+// Type of the value expected by a slot of a JsonTemplate.
+enum class JsonSlotKind
+{
+  Null,
+  Bool,
+  Integer,
+  Float,
+  String,
+};
+
+// Position in the output of a writer where a JsonTemplate inserts a value.
+struct JsonSlot
+{
+  size_t offset;
+  JsonSlotKind kind;
+};
+
+class JsonTemplate;
+class JsonTokenStream;
+
+// Whether a formatting mode of BasicJsonWriter is fixed at compile time (Off
+// or On) or selected at runtime with set_pretty() or set_use_colors().
+enum class JsonMode
+{
+  Off,
+  On,
+  Runtime,
+};
+
+// How BasicJsonWriter escapes strings, fixed at compile time so that the
+// default policy does not pay for the others. Flags can be combined with |.
+// JsonKey, JsonTemplate, JsonTokenStream and JsonFragmentCache follow the
+// policy of the writer they are used with. write_raw_json() copies its input
+// as is.
+enum class JsonEscape : unsigned
+{
+  // Quotes, backslashes, \n, \r, \t and \f are escaped, other bytes are copied.
+  Default = 0,
+  // Every control character is escaped, as \b, \f, \n, \r, \t or \u00XX.
+  Controls = 1 << 0,
+  // Each byte of an invalid UTF-8 sequence is replaced by U+FFFD.
+  ReplaceInvalidUtf8 = 1 << 1,
+  // Invalid UTF-8 sequences are dropped and reported by has_invalid_utf8().
+  // This takes precedence over ReplaceInvalidUtf8.
+  RejectInvalidUtf8 = 1 << 2,
+  // Non-ASCII characters are escaped as \uXXXX, using surrogate pairs outside
+  // of the BMP. Invalid sequences are replaced unless rejected.
+  Ascii = 1 << 3,
+  // <, > and & are escaped as \u003c, \u003e and \u0026, so that the output
+  // can be embedded in HTML.
+  Html = 1 << 4,
+};
+
+constexpr JsonEscape
+operator|(JsonEscape lhs, JsonEscape rhs)
+{
+  return static_cast<JsonEscape>(static_cast<unsigned>(lhs) | static_cast<unsigned>(rhs));
+}
+
+// How BasicJsonWriter::write_float() writes NaN and infinities.
+enum class JsonNonFinite
+{
+  // As null.
+  Null,
+  // As the strings "NaN", "Infinity" and "-Infinity".
+  String,
+  // As the bare NaN, Infinity and -Infinity literals. This is not valid JSON
+  // but is accepted by JSON5 and many JavaScript-based parsers.
+  Literal,
+};
+
+// Alphabet of BasicJsonWriter::write_base64(), see RFC 4648.
+enum class JsonBase64
+{
+  // A-Z, a-z, 0-9, + and /, padded with = to a multiple of 4 characters.
+  Standard,
+  // A-Z, a-z, 0-9, - and _, without padding, as in URLs and JWTs.
+  Url,
+};
+
+// Statistics collected by BasicJsonWriter when JSON_WRITER_ENABLE_STATS is
+// defined, since the last reset() or reset_stats().
+struct JsonWriterStats
+{
+  struct Counter
+  {
+    // Number of calls, or of values for the bulk array functions.
+    uint64_t count = 0;
+    // Bytes written, colors and indentation included.
+    uint64_t bytes = 0;
+    // Timestamp counter cycles, only with JSON_WRITER_ENABLE_CYCLE_STATS.
+    uint64_t cycles = 0;
+
+    void merge(const Counter& other)
+    {
+      count += other.count;
+      bytes += other.bytes;
+      cycles += other.cycles;
+    }
+  };
+
+  Counter nulls;
+  Counter bools;
+  Counter strings;
+  Counter integers;
+  Counter floats;
+  // Values replayed by a JsonTokenStream, already formatted.
+  Counter formatted;
+  Counter field_names;
+  // Brackets, separators and the indentation that comes with them.
+  Counter structure;
+
+  // Newlines and indentation of pretty mode, also included above.
+  uint64_t indent_bytes = 0;
+  // Color escape sequences, also included above.
+  uint64_t color_bytes = 0;
+  // Characters of strings and field names written as an escape sequence,
+  // replaced or dropped.
+  uint64_t escaped_chars = 0;
+  // Times the capacity of the buffer changed while writing.
+  uint64_t reallocations = 0;
+  // Largest size reached by the buffer.
+  size_t peak_size = 0;
+  // Bytes handed to the sink.
+  uint64_t flushed_bytes = 0;
+  int max_depth = 0;
+
+  void merge(const JsonWriterStats& other)
+  {
+    nulls.merge(other.nulls);
+    bools.merge(other.bools);
+    strings.merge(other.strings);
+    integers.merge(other.integers);
+    floats.merge(other.floats);
+    formatted.merge(other.formatted);
+    field_names.merge(other.field_names);
+    structure.merge(other.structure);
+    indent_bytes += other.indent_bytes;
+    color_bytes += other.color_bytes;
+    escaped_chars += other.escaped_chars;
+    reallocations += other.reallocations;
+    peak_size = std::max(peak_size, other.peak_size);
+    flushed_bytes += other.flushed_bytes;
+    max_depth = std::max(max_depth, other.max_depth);
+  }
+};
+
+// Output buffer over caller-provided memory, given instead of an allocator to
+// BasicJsonWriter (see SpanJsonWriter) to write without any allocation. The
+// capacity is checked once per value. Once the output does not fit, nothing
+// more is stored but the writer keeps going so that size() still gives the
+// size of the whole output: has_overflow() then stays set until the next
+// reset(), and the output can be written again in a span of size() bytes.
+class JsonSpanBuffer
+{
+public:
+  // Values that do not fit are formatted in a per-thread scratch area of this
+  // size, to count their size. The rare values that may need more, such as
+  // write_float() with a precision in the thousands, use a heap-allocated area.
+  static constexpr size_t OVERFLOW_SCRATCH_SIZE = 4096;
+
+  JsonSpanBuffer() = default;
+  JsonSpanBuffer(char* data, size_t capacity)
+    : m_data(data)
+    , m_capacity(capacity)
+  {
+  }
+  template<size_t N>
+  explicit JsonSpanBuffer(char (&data)[N])
+    : JsonSpanBuffer(data, N)
+  {
+  }
+
+  // Size of the whole output, even if it did not fit.
+  size_t size() const { return m_size; }
+  size_t capacity() const { return m_capacity; }
+  bool empty() const { return m_size == 0; }
+  bool has_overflow() const { return m_stored_size != m_size; }
+
+  // The stored output, which is all of it unless has_overflow().
+  const char* data() const { return m_data; }
+  std::string_view view() const { return std::string_view(m_data, m_stored_size); }
+  operator std::string_view() const { return view(); }
+
+  // An empty buffer over the same memory.
+  JsonSpanBuffer get_allocator() const { return JsonSpanBuffer(m_data, m_capacity); }
+
+  void clear()
+  {
+    m_size = 0;
+    m_stored_size = 0;
+  }
+  void reserve(size_t) {}
+
+  void push_back(char ch)
+  {
+    if (m_stored_size == m_size && (m_size < m_capacity || grow(m_size + 1)))
+      m_data[m_stored_size++] = ch;
+    ++m_size;
+  }
+  void append(const char* data, size_t size)
+  {
+    if (m_stored_size == m_size && (m_capacity - m_size >= size || grow(m_size + size))) {
+      std::memcpy(m_data + m_size, data, size);
+      m_stored_size += size;
+    }
+    m_size += size;
+  }
+  void append(std::string_view text) { append(text.data(), text.size()); }
+
+  // Returns room for max_size characters, to be followed by commit() with the
+  // end of the characters written.
+  char* prepare(size_t max_size)
+  {
+    m_is_prepared_in_place =
+      m_stored_size == m_size && (m_capacity - m_size >= max_size || grow(m_size + max_size));
+    m_prepared = m_is_prepared_in_place ? m_data + m_size : get_overflow_scratch(max_size);
+    return m_prepared;
+  }
+  void commit(char* end)
+  {
+    const size_t size = end - m_prepared;
+    if (m_is_prepared_in_place) {
+      m_stored_size += size;
+      m_size += size;
+    } else {
+      // The value may still fit, its maximum size did not.
+      append(m_prepared, size);
+    }
+  }
+
+protected:
+  // Called when the output does not fit, to move it with set_storage() to a
+  // memory block of at least min_capacity characters. Returns false if the
+  // buffer cannot grow.
+  using GrowFunc = bool (*)(JsonSpanBuffer& buffer, size_t min_capacity);
+
+  void set_grow_func(GrowFunc grow) { m_grow = grow; }
+  char* get_storage() const { return m_data; }
+  void set_storage(char* data, size_t capacity)
+  {
+    m_data = data;
+    m_capacity = capacity;
+  }
+
+private:
+  bool grow(size_t min_capacity) { return m_grow != nullptr && m_grow(*this, min_capacity); }
+
+  static char* get_overflow_scratch(size_t size)
+  {
+    static thread_local char scratch[OVERFLOW_SCRATCH_SIZE];
+    if (size <= OVERFLOW_SCRATCH_SIZE)
+      return scratch;
+
+    static thread_local std::unique_ptr<char[]> large_scratch;
+    static thread_local size_t large_scratch_size = 0;
+    if (large_scratch_size < size) {
+      large_scratch.reset(new char[size]);
+      large_scratch_size = size;
+    }
+    return large_scratch.get();
+  }
+
+  char* m_data = nullptr;
+  size_t m_capacity = 0;
+  size_t m_size = 0;
+  size_t m_stored_size = 0;
+  char* m_prepared = nullptr;
+  bool m_is_prepared_in_place = false;
+  GrowFunc m_grow = nullptr;
+};
+
+namespace json_detail {
+// Type of the output buffer of a writer, from its allocator. Buffers deriving
+// from JsonSpanBuffer are written like it.
+template<class Allocator>
+struct WriterBuffer
+{
+  using type = std::basic_string<char, std::char_traits<char>, Allocator>;
+};
+
+template<>
+struct WriterBuffer<JsonSpanBuffer>
+{
+  using type = JsonSpanBuffer;
+};
+
+// Whether the buffer is the final output, which gather mode cannot reference.
+template<class Buffer>
+struct IsFileBuffer : std::false_type
+{
+};
+} // namespace json_detail
+
+#ifdef JSON_WRITER_HAS_POSIX
+// File written by MmapJsonWriter, given instead of an allocator to
+// BasicJsonWriter. fd must be open for reading and writing and is not closed.
+// The file is extended by chunk_size bytes at a time. If sequential is true,
+// the kernel is advised that the mapping is written sequentially so that it
+// can flush and reclaim pages early.
+class JsonMmapFile
+{
+public:
+  static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024 * 1024;
+
+  JsonMmapFile() = default;
+  explicit JsonMmapFile(int fd, size_t chunk_size = DEFAULT_CHUNK_SIZE, bool sequential = true)
+    : m_fd(fd)
+    , m_chunk_size(chunk_size)
+    , m_sequential(sequential)
+  {
+  }
+
+  int get_fd() const { return m_fd; }
+  size_t get_chunk_size() const { return m_chunk_size; }
+  bool is_sequential() const { return m_sequential; }
+
+private:
+  int m_fd = -1;
+  size_t m_chunk_size = DEFAULT_CHUNK_SIZE;
+  bool m_sequential = true;
+};
+
+// Output buffer of MmapJsonWriter: a shared mapping of the file, in which the
+// writer formats directly, replacing the content of the file. close(), also
+// called by the destructor, truncates the file to the output size. If the file
+// cannot grow, has_error() is set and the output is only counted, like for an
+// overflowing JsonSpanBuffer.
+class JsonMmapFileBuffer : public JsonSpanBuffer
+{
+public:
+  JsonMmapFileBuffer() = default;
+  explicit JsonMmapFileBuffer(const JsonMmapFile& file);
+  JsonMmapFileBuffer(JsonMmapFileBuffer&& other) noexcept;
+  JsonMmapFileBuffer& operator=(JsonMmapFileBuffer&& other) noexcept;
+  ~JsonMmapFileBuffer();
+
+  JsonMmapFile get_allocator() const { return m_file; }
+
+  // Unmaps the file and truncates it to the output size. Nothing may be
+  // written afterwards. Returns false if the output could not be written.
+  bool close();
+
+  bool has_error() const { return m_has_error; }
+
+private:
+  static bool grow(JsonSpanBuffer& buffer, size_t min_capacity);
+  bool map(size_t min_capacity);
+
+  JsonMmapFile m_file;
+  bool m_is_open = false;
+  bool m_has_error = false;
+};
+
+namespace json_detail {
+template<>
+struct WriterBuffer<JsonMmapFile>
+{
+  using type = JsonMmapFileBuffer;
+};
+
+template<>
+struct IsFileBuffer<JsonMmapFileBuffer> : std::true_type
+{
+};
+} // namespace json_detail
+#endif
+
+// The output is allocated with Allocator, or stored in caller-provided memory
+// when it is JsonSpanBuffer, or in a file when it is JsonMmapFile.
+template<JsonMode Pretty,
+         JsonMode Colored,
+         JsonEscape Escape = JsonEscape::Default,
+         class Allocator = std::allocator<char>>
+class BasicJsonWriter
+{
+public:
+  using Colors = JsonColors;
+  using String = typename json_detail::WriterBuffer<Allocator>::type;
+
+  BasicJsonWriter() = default;
+  // The output buffer is allocated with allocator, e.g. a
+  // std::pmr::polymorphic_allocator over an arena for PmrJsonWriter, or is
+  // the given JsonSpanBuffer.
+  explicit BasicJsonWriter(const Allocator& allocator)
+    : m_buffer(allocator)
+  {
+  }
+
+  Allocator get_allocator() const { return m_buffer.get_allocator(); }
+
+  const String& get_buffer() const { return m_buffer; }
+
+  // Preallocates the output buffer.
+  void reserve(size_t capacity) { m_buffer.reserve(capacity); }
+  // Discards the output and starts a new document. The buffer keeps its
+  // capacity and the configuration (modes, colors, sink) is unchanged.
+  void reset();
+  // Moves the output out of the writer without copying it, then starts a new
+  // document with an empty buffer from the same allocator. A MmapJsonWriter is
+  // left without a file and only counts what is written afterwards.
+  String take_buffer();
+  // Exchanges the output with buffer, then starts a new document in the
+  // previous content of buffer (cleared but keeping its capacity). This
+  // allows recycling a buffer once its content has been consumed. buffer
+  // must use an allocator equal to the one of the writer.
+  void swap_buffer(String& buffer);
+
+  Colors& get_colors() { return m_colors; }
+  const Colors& get_colors() const { return m_colors; }
+
+  void set_use_colors(bool use_colors)
+  {
+    static_assert(Colored == JsonMode::Runtime, "colors are fixed at compile time for this writer");
+    m_use_colors = use_colors;
+  }
+  void set_pretty(bool pretty)
+  {
+    static_assert(Pretty == JsonMode::Runtime, "pretty mode is fixed at compile time for this writer");
+    m_pretty = pretty;
+  }
+
+  bool is_pretty() const
+  {
+    if constexpr (Pretty == JsonMode::Runtime)
+      return m_pretty;
+    else
+      return Pretty == JsonMode::On;
+  }
+  bool use_colors() const
+  {
+    if constexpr (Colored == JsonMode::Runtime)
+      return m_use_colors;
+    else
+      return Colored == JsonMode::On;
+  }
+
+  // JSON has no representation for NaN and infinities, see JsonNonFinite.
+  void set_non_finite(JsonNonFinite non_finite) { m_non_finite = non_finite; }
+
+  // Whether an invalid UTF-8 sequence was dropped since the last reset, with
+  // the JsonEscape::RejectInvalidUtf8 policy.
+  bool has_invalid_utf8() const { return m_has_invalid_utf8; }
+
+#ifdef JSON_WRITER_ENABLE_STATS
+  const JsonWriterStats& get_stats() const { return m_stats; }
+  void reset_stats() { m_stats = JsonWriterStats(); }
+  // Called by reset() (hence also by take_buffer(), swap_buffer() and when a
+  // pooled writer is returned) with the statistics of the finished document,
+  // before they are cleared.
+  void set_stats_callback(std::function<void(const JsonWriterStats&)> callback)
+  {
+    m_stats_callback = std::move(callback);
+  }
+#endif
+
+  static constexpr size_t DEFAULT_SINK_BUFFER_SIZE = 64 * 1024;
+
+  // Redirects the output to sink. The output is then staged in get_buffer()
+  // and handed to the sink each time it grows past buffer_size, so the memory
+  // usage does not depend on the size of the document. Call flush() once the
+  // document is complete. A null sink restores the default behavior where the
+  // whole output is kept in get_buffer().
+  void set_sink(JsonSink* sink, size_t buffer_size = DEFAULT_SINK_BUFFER_SIZE);
+  void flush();
+
+  static constexpr size_t MEASURE_BUFFER_SIZE = 4 * 1024;
+
+  // Returns the number of bytes write(writer) would append at the current
+  // position, colors and indentation included, by calling it on a writer with
+  // the same configuration whose output is only counted. The values are still
+  // formatted, so measuring costs about as much as writing; it is worth it
+  // when the buffer must be allocated once at its exact size, for instance to
+  // bound the peak memory of large documents:
+  //   writer.reserve(writer.get_buffer().size() + writer.measure(write));
+  //   write(writer);
+  template<class F>
+  size_t measure(F write) const;
+
+  // Strings of at least this size may be referenced instead of copied in
+  // gather mode.
+  static constexpr size_t GATHER_MIN_SIZE = 256;
+
+  // In gather mode, write_string_ref() records references to large strings
+  // instead of copying them, and the output becomes a list of segments
+  // alternating between the buffer and the referenced strings, to be retrieved
+  // with get_segments() or written with write_segments(). get_buffer() then
+  // only holds the bytes owned by the writer. Gather mode is ignored when a
+  // sink is set and by MmapJsonWriter.
+  void set_gather_mode(bool gather_mode) { m_gather_mode = gather_mode; }
+  // Writes value as a string. In gather mode, if value needs no escaping and is
+  // large enough, only a reference to it is kept: the caller must then keep
+  // value alive and unchanged until the output has been consumed and the
+  // writer reset. Otherwise, this is the same as write_string().
+  void write_string_ref(std::string_view value);
+
+  // Returns the output as a list of segments, in order.
+  std::vector<std::string_view> get_segments() const;
+  // Total size of the output, including the referenced strings.
+  size_t get_output_size() const;
+#ifdef JSON_WRITER_HAS_POSIX
+  // Writes the segments to fd with as few writev() calls as possible. Returns
+  // false on error, with errno set.
+  bool write_segments(int fd) const;
+#endif
+
+  // JSON Lines (NDJSON) output: each record is a compact top-level value
+  // followed by a newline, appended after the previous records. Records are
+  // always compact, even if the writer is in pretty mode. With a sink, records
+  // are never split between two writes: they are handed to the sink once the
+  // buffered output reaches the sink buffer size or max_records records.
+  void begin_record();
+  void end_record();
+  void set_max_batch_records(size_t max_records) { m_max_batch_records = max_records; }
+
+  // Leaves room for a value of the given kind, to be filled later by a
+  // JsonTemplate built from this writer. Slots are not supported with a sink.
+  void write_slot(JsonSlotKind kind);
+  const std::vector<JsonSlot>& get_slots() const { return m_slots; }
+
+  void begin_object();
+  void end_object();
+
+  void begin_array();
+  void end_array();
+
+  void begin_array_item();
+  void end_array_item();
+
+  void begin_field(std::string_view name);
+  void begin_field(const JsonKey& key);
+  void end_field();
+
+  void write_null();
+  void write_bool(bool value);
+  void write_string(std::string_view value);
+  template<class T>
+  void write_integer(T value)
+  {
+    StatsScope stats_scope(*this, &JsonWriterStats::integers);
+    using Unsigned = typename json_detail::MakeUnsigned<T>::type;
+    using Wide = std::conditional_t<sizeof(Unsigned) <= sizeof(uint64_t), uint64_t, Unsigned>;
+    const bool is_negative = json_detail::is_negative(value);
+    const Unsigned bits = static_cast<Unsigned>(value);
+    const Wide magnitude = is_negative ? static_cast<Unsigned>(Unsigned(0) - bits) : bits;
+    const int digit_count = json_detail::count_digits(magnitude);
+
+    set_color(m_colors.number);
+    // The exact length is known beforehand, so the digits are written in place.
+    char* out = prepare_append(is_negative + digit_count);
+    if (is_negative)
+      *out++ = '-';
+    out += digit_count;
+    json_detail::write_digits(out, magnitude);
+    commit_append(out);
+    reset_color();
+  }
+  // Writes the shortest representation that reads back as the same value.
+  template<class T>
+  void write_float(T value)
+  {
+    if (!std::isfinite(value)) {
+      write_non_finite(value);
+      return;
+    }
+
+    StatsScope stats_scope(*this, &JsonWriterStats::floats);
+    constexpr size_t MAX_SIZE =
+      5 + std::numeric_limits<T>::max_digits10 + std::max(2, log10ceil(std::numeric_limits<T>::max_exponent10));
+    set_color(m_colors.number);
+    append_to_chars(MAX_SIZE, value);
+    reset_color();
+  }
+  // Writes value in fixed notation with exactly precision decimals. A negative
+  // precision means 6, as for std::to_chars.
+  template<class T>
+  void write_float(T value, int precision)
+  {
+    if (!std::isfinite(value)) {
+      write_non_finite(value);
+      return;
+    }
+
+    // Checked before it is added to the buffer sizes below.
+    if (precision < 0)
+      precision = 6;
+    StatsScope stats_scope(*this, &JsonWriterStats::floats);
+    // Enough for typical values, retried with the worst case otherwise.
+    constexpr size_t COMMON_SIZE = 24;
+    constexpr size_t MAX_SIZE = 3 + std::numeric_limits<T>::max_exponent10;
+    set_color(m_colors.number);
+    if (!append_to_chars(COMMON_SIZE + precision, value, std::chars_format::fixed, precision))
+      append_to_chars(MAX_SIZE + precision, value, std::chars_format::fixed, precision);
+    reset_color();
+  }
+  // Writes size bytes of binary data as a base64 string, encoded directly into
+  // the output.
+  void write_base64(const void* data, size_t size, JsonBase64 alphabet = JsonBase64::Standard);
+  template<class Container>
+  void write_base64(const Container& bytes, JsonBase64 alphabet = JsonBase64::Standard)
+  {
+    static_assert(sizeof(*std::data(bytes)) == 1, "write_base64() expects a container of bytes");
+    write_base64(std::data(bytes), std::size(bytes), alphabet);
+  }
+  // Writes json, a JSON value rendered beforehand (for instance by a
+  // JsonFragmentCache), which is not validated. Compact writers without colors
+  // copy values without whitespace outside of strings as is. Otherwise the
+  // value is rendered again with the indentation and colors of this writer, as
+  // if each of its values had been written by a call.
+  void write_raw_json(std::string_view json);
+
+  void write_null_field(std::string_view name)
+  {
+    begin_field(name);
+    write_null();
+    end_field();
+  }
+  void write_bool_field(std::string_view name, bool value)
+  {
+    begin_field(name);
+    write_bool(value);
+    end_field();
+  }
+  void write_string_field(std::string_view name, std::string_view value)
+  {
+    begin_field(name);
+    write_string(value);
+    end_field();
+  }
+  template<class T>
+  void write_integer_field(std::string_view name, T value)
+  {
+    begin_field(name);
+    write_integer(value);
+    end_field();
+  }
+  template<class T>
+  void write_float_field(std::string_view name, T value)
+  {
+    begin_field(name);
+    write_float(value);
+    end_field();
+  }
+  template<class T>
+  void write_float_field(std::string_view name, T value, int precision)
+  {
+    begin_field(name);
+    write_float(value, precision);
+    end_field();
+  }
+  void write_base64_field(std::string_view name,
+                          const void* data,
+                          size_t size,
+                          JsonBase64 alphabet = JsonBase64::Standard)
+  {
+    begin_field(name);
+    write_base64(data, size, alphabet);
+    end_field();
+  }
+  template<class Container>
+  void write_base64_field(std::string_view name, const Container& bytes, JsonBase64 alphabet = JsonBase64::Standard)
+  {
+    begin_field(name);
+    write_base64(bytes, alphabet);
+    end_field();
+  }
+  void write_raw_json_field(std::string_view name, std::string_view json)
+  {
+    begin_field(name);
+    write_raw_json(json);
+    end_field();
+  }
+
+  void write_null_field(const JsonKey& key)
+  {
+    begin_field(key);
+    write_null();
+    end_field();
+  }
+  void write_bool_field(const JsonKey& key, bool value)
+  {
+    begin_field(key);
+    write_bool(value);
+    end_field();
+  }
+  void write_string_field(const JsonKey& key, std::string_view value)
+  {
+    begin_field(key);
+    write_string(value);
+    end_field();
+  }
+  template<class T>
+  void write_integer_field(const JsonKey& key, T value)
+  {
+    begin_field(key);
+    write_integer(value);
+    end_field();
+  }
+  template<class T>
+  void write_float_field(const JsonKey& key, T value)
+  {
+    begin_field(key);
+    write_float(value);
+    end_field();
+  }
+  template<class T>
+  void write_float_field(const JsonKey& key, T value, int precision)
+  {
+    begin_field(key);
+    write_float(value, precision);
+    end_field();
+  }
+  void write_base64_field(const JsonKey& key, const void* data, size_t size, JsonBase64 alphabet = JsonBase64::Standard)
+  {
+    begin_field(key);
+    write_base64(data, size, alphabet);
+    end_field();
+  }
+  template<class Container>
+  void write_base64_field(const JsonKey& key, const Container& bytes, JsonBase64 alphabet = JsonBase64::Standard)
+  {
+    begin_field(key);
+    write_base64(bytes, alphabet);
+    end_field();
+  }
+  void write_raw_json_field(const JsonKey& key, std::string_view json)
+  {
+    begin_field(key);
+    write_raw_json(json);
+    end_field();
+  }
+
+  template<class It, class F>
+  void write_array(It begin, It end, F func)
+  {
+    begin_array();
+
+    for (auto it = begin; it != end; ++it) {
+      begin_array_item();
+      func(*this, *it);
+      end_array_item();
+    }
+
+    end_array();
+  }
+
+  // Produces the same output as write_array() but serializes the items on
+  // thread_count threads (the hardware concurrency by default). Each thread
+  // renders a contiguous range of items into its own writer, at the current
+  // indentation, and the fragments are then appended in order. func is called
+  // concurrently, with the sub-writer as first argument. It requires random
+  // access iterators. The sub-writers use a default-constructed allocator.
+  template<class It, class F>
+  void write_array_parallel(It begin, It end, F func, unsigned thread_count = 0);
+
+  // Write an array of numbers, with the same output as write_array() calling
+  // write_integer() or write_float() on each value, but formatted in a single
+  // pass over a preallocated buffer.
+  template<class T>
+  void write_integer_array(const T* values, size_t count);
+  template<class Container>
+  void write_integer_array(const Container& values)
+  {
+    write_integer_array(std::data(values), std::size(values));
+  }
+  template<class T>
+  void write_float_array(const T* values, size_t count);
+  template<class Container>
+  void write_float_array(const Container& values)
+  {
+    write_float_array(std::data(values), std::size(values));
+  }
+
+private:
+  // Adds the bytes written and the cycles spent during its lifetime to a
+  // counter of the statistics, and records the growth of the buffer. It does
+  // nothing unless JSON_WRITER_ENABLE_STATS is defined.
+  class StatsScope
+  {
+  public:
+#ifdef JSON_WRITER_ENABLE_STATS
+    StatsScope(BasicJsonWriter& writer, JsonWriterStats::Counter JsonWriterStats::*counter, uint64_t count = 1)
+      : m_writer(writer)
+      , m_counter(writer.m_stats.*counter)
+      , m_count(count)
+      , m_old_size(writer.get_written_size())
+      , m_old_capacity(writer.m_buffer.capacity())
+      , m_start_cycles(json_detail::read_cycle_counter())
+    {
+    }
+    ~StatsScope()
+    {
+      m_counter.cycles += json_detail::read_cycle_counter() - m_start_cycles;
+      m_counter.count += m_count;
+      m_counter.bytes += m_writer.get_written_size() - m_old_size;
+      m_writer.update_buffer_stats(m_old_capacity);
+    }
+
+  private:
+    BasicJsonWriter& m_writer;
+    JsonWriterStats::Counter& m_counter;
+    uint64_t m_count;
+    uint64_t m_old_size;
+    size_t m_old_capacity;
+    uint64_t m_start_cycles;
+#else
+    template<class... Args>
+    explicit StatsScope(Args&&...)
+    {
+    }
+#endif
+  };
+
+#ifdef JSON_WRITER_ENABLE_STATS
+  // Bytes written since the statistics were cleared, flushed ones included.
+  uint64_t get_written_size() const { return m_stats.flushed_bytes + m_buffer.size(); }
+  void update_buffer_stats(size_t old_capacity)
+  {
+    if (m_buffer.capacity() != old_capacity)
+      ++m_stats.reallocations;
+    m_stats.peak_size = std::max(m_stats.peak_size, m_buffer.size());
+  }
+  void update_depth_stats() { m_stats.max_depth = std::max(m_stats.max_depth, m_indent_level); }
+#endif
+
+  template<typename T>
+  static constexpr int log10ceil(T num)
+  {
+    return num < 10 ? 1 : 1 + log10ceil(num / 10);
+  }
+
+  // Formats value with std::to_chars directly at the end of the buffer, in at
+  // most max_size characters. Returns false (leaving the buffer unchanged) if
+  // the value did not fit.
+  template<class T, class... Args>
+  bool append_to_chars(size_t max_size, T value, Args... args)
+  {
+    char* first = prepare_append(max_size);
+    const std::to_chars_result result = std::to_chars(first, first + max_size, value, args...);
+    if (result.ec != std::errc()) {
+      commit_append(first);
+      return false;
+    }
+
+    commit_append(result.ptr);
+    return true;
+  }
+
+  static constexpr bool HAS_SPAN_BUFFER = std::is_base_of_v<JsonSpanBuffer, String>;
+
+  // Returns room for max_size characters at the end of the buffer, to be
+  // written through a raw pointer then kept with commit_append(end).
+  char* prepare_append(size_t max_size)
+  {
+    if constexpr (HAS_SPAN_BUFFER) {
+      return m_buffer.prepare(max_size);
+    } else {
+      const size_t old_size = m_buffer.size();
+      m_buffer.resize(old_size + max_size);
+      return &m_buffer[old_size];
+    }
+  }
+  void commit_append(char* end)
+  {
+    if constexpr (HAS_SPAN_BUFFER)
+      m_buffer.commit(end);
+    else
+      m_buffer.resize(end - m_buffer.data());
+  }
+
+  template<class T>
+  void write_non_finite(T value);
+  template<class T>
+  char* write_non_finite(char* out, T value) const;
+
+  // Writes a numeric array, each item being formatted by format(out, value) in
+  // at most max_size characters, or by write_item(writer, value) in colored
+  // mode.
+  template<class T, class F, class G>
+  void write_number_array(const T* values, size_t count, size_t max_size, F format, G write_item);
+
+  void set_color(const char* color);
+  void reset_color();
+
+  void write_indent();
+  void write_separator();
+  void write_closing_newline();
+  void write_quoted_string(std::string_view value);
+  // Writes a value already formatted (and quoted for strings).
+  void write_formatted(const char* color, std::string_view text);
+  // write_raw_json(), where is_compact tells whether json has no whitespace
+  // outside of its strings.
+  void write_raw_json(std::string_view json, bool is_compact);
+  // Copies json without its whitespace, with the indentation of this writer
+  // in pretty mode.
+  void reflow_raw_json(std::string_view json);
+  // Renders the JSON value starting at it with the calls of the writer, and
+  // returns its end.
+  const char* write_raw_value(const char* it, const char* end);
+  // Begins a field whose name is already quoted and followed by the colon.
+  void begin_quoted_field(std::string_view quoted_name);
+  static char* write_escaped_char(char* out, char ch);
+  char* write_escaped_utf8(char* out, const char*& it, const char* end);
+  static char* write_unicode_escape(char* out, uint32_t code_unit);
+
+  static constexpr bool has_escape_flag(JsonEscape flag)
+  {
+    return (static_cast<unsigned>(Escape) & static_cast<unsigned>(flag)) != 0;
+  }
+  static constexpr bool VALIDATES_UTF8 = has_escape_flag(JsonEscape::ReplaceInvalidUtf8) ||
+                                         has_escape_flag(JsonEscape::RejectInvalidUtf8) ||
+                                         has_escape_flag(JsonEscape::Ascii);
+  static constexpr unsigned FIND_CLASSES = (has_escape_flag(JsonEscape::Html) ? json_detail::FIND_HTML : 0u) |
+                                           (VALIDATES_UTF8 ? json_detail::FIND_NON_ASCII : 0u);
+
+  // Like json_detail::needs_escape() and find_escape() but for the escaping
+  // policy.
+  static bool needs_escape(char ch)
+  {
+    return json_detail::needs_escape(ch) ||
+           (has_escape_flag(JsonEscape::Html) && (ch == '<' || ch == '>' || ch == '&')) ||
+           (VALIDATES_UTF8 && static_cast<unsigned char>(ch) >= 0x80);
+  }
+  static const char* find_escape(const char* begin, const char* end)
+  {
+    if constexpr (FIND_CLASSES == 0)
+      return json_detail::find_escape(begin, end);
+    else if constexpr (VALIDATES_UTF8 && !has_escape_flag(JsonEscape::Ascii))
+      return json_detail::find_escape_utf8(begin, end, FIND_CLASSES & ~json_detail::FIND_NON_ASCII);
+    else
+      return json_detail::find_escape(begin, end, FIND_CLASSES);
+  }
+
+  void flush_if_full();
+
+  // Returns a writer with the same configuration and indentation, that
+  // continues the current container, and allocates with allocator.
+  BasicJsonWriter make_fragment_writer(const Allocator& allocator) const;
+
+private:
+  friend class JsonTemplate;
+  friend class JsonTokenStream;
+  friend class JsonFragmentCache;
+
+  String m_buffer;
+  JsonSink* m_sink = nullptr;
+  size_t m_sink_buffer_size = DEFAULT_SINK_BUFFER_SIZE;
+  Colors m_colors;
+  int m_indent_level = 0;
+  bool m_is_first_element = true;
+  JsonNonFinite m_non_finite = JsonNonFinite::Null;
+  // String referenced in gather mode, inserted at offset in m_buffer.
+  struct GatherRef
+  {
+    size_t offset;
+    std::string_view data;
+  };
+  std::vector<GatherRef> m_gather_refs;
+  bool m_gather_mode = false;
+  std::vector<JsonSlot> m_slots;
+  // Records buffered since the last flush and the limit, see begin_record().
+  size_t m_batch_records = 0;
+  size_t m_max_batch_records = std::numeric_limits<size_t>::max();
+  bool m_in_record = false;
+  bool m_record_saved_pretty = true;
+  bool m_has_invalid_utf8 = false;
+  bool m_use_colors = false;
+  bool m_pretty = true;
+#ifdef JSON_WRITER_ENABLE_STATS
+  JsonWriterStats m_stats;
+  std::function<void(const JsonWriterStats&)> m_stats_callback;
+#endif
+};
+
+// Writer whose modes are selected at runtime.
+using JsonWriter = BasicJsonWriter<JsonMode::Runtime, JsonMode::Runtime>;
+// Writer producing compact uncolored output, without any formatting branch.
+using CompactJsonWriter = BasicJsonWriter<JsonMode::Off, JsonMode::Off>;
+
+// Writers storing their output in caller-provided memory, without allocating:
+//   char storage[512];
+//   SpanCompactJsonWriter writer(JsonSpanBuffer{ storage });
+//   ...
+//   if (writer.get_buffer().has_overflow())
+//     // Retry with writer.get_buffer().size() bytes.
+// take_buffer(), swap_buffer() and write_array_parallel() are not supported,
+// and a sink buffer size must leave room for the values written before each
+// flush. In gather mode, get_segments() only covers the stored output.
+using SpanJsonWriter = BasicJsonWriter<JsonMode::Runtime, JsonMode::Runtime, JsonEscape::Default, JsonSpanBuffer>;
+using SpanCompactJsonWriter = BasicJsonWriter<JsonMode::Off, JsonMode::Off, JsonEscape::Default, JsonSpanBuffer>;
+
+#ifdef JSON_WRITER_HAS_POSIX
+// Writers formatting their output directly in a memory mapping of a file,
+// without staging it:
+//   MmapCompactJsonWriter writer(JsonMmapFile{ fd });
+//   ...
+//   if (!writer.take_buffer().close())
+//     // The file could not be written.
+// The writer no longer writes to the file after take_buffer().
+// Like span writers, they support neither swap_buffer() nor
+// write_array_parallel(), and they take no sink.
+using MmapJsonWriter = BasicJsonWriter<JsonMode::Runtime, JsonMode::Runtime, JsonEscape::Default, JsonMmapFile>;
+using MmapCompactJsonWriter = BasicJsonWriter<JsonMode::Off, JsonMode::Off, JsonEscape::Default, JsonMmapFile>;
+#endif
+
+#ifdef __cpp_lib_memory_resource
+// Writers whose buffer is allocated from a std::pmr::memory_resource given to
+// the constructor, such as a per-request std::pmr::monotonic_buffer_resource
+// released in one shot once the output has been consumed:
+//   std::pmr::monotonic_buffer_resource arena(64 * 1024);
+//   PmrCompactJsonWriter writer(&arena);
+using PmrJsonWriter =
+  BasicJsonWriter<JsonMode::Runtime, JsonMode::Runtime, JsonEscape::Default, std::pmr::polymorphic_allocator<char>>;
+using PmrCompactJsonWriter =
+  BasicJsonWriter<JsonMode::Off, JsonMode::Off, JsonEscape::Default, std::pmr::polymorphic_allocator<char>>;
+#endif
+
+// Per-thread cache of writers. A writer returned to the pool keeps the
+// capacity of its buffer, so serializing documents of similar sizes reaches a
+// steady state without any allocation. Writers are reset and detached from
+// their sink when returned; other settings (modes, colors) are kept.
+template<class Writer = JsonWriter>
+class JsonWriterPool
+{
+public:
+  static constexpr size_t MAX_POOLED_WRITERS = 16;
+
+  // Gives back the writer to the pool of the current thread when destroyed.
+  class Handle
+  {
+  public:
+    Handle(Handle&& other) noexcept
+      : m_writer(std::move(other.m_writer))
+    {
+    }
+    Handle& operator=(Handle&& other) noexcept
+    {
+      release();
+      m_writer = std::move(other.m_writer);
+      return *this;
+    }
+    ~Handle() { release(); }
+
+    Writer& operator*() const { return *m_writer; }
+    Writer* operator->() const { return m_writer.get(); }
+
+  private:
+    friend class JsonWriterPool;
+
+    explicit Handle(std::unique_ptr<Writer> writer)
+      : m_writer(std::move(writer))
+    {
+    }
+
+    void release()
+    {
+      if (m_writer != nullptr)
+        JsonWriterPool::release(std::move(m_writer));
+    }
+
+    std::unique_ptr<Writer> m_writer;
+  };
+
+  // Checks out a writer from the pool of the current thread, creating one if
+  // the pool is empty.
+  static Handle acquire()
+  {
+    std::vector<std::unique_ptr<Writer>>& free_writers = get_free_writers();
+    if (free_writers.empty())
+      return Handle(std::make_unique<Writer>());
+
+    std::unique_ptr<Writer> writer = std::move(free_writers.back());
+    free_writers.pop_back();
+    return Handle(std::move(writer));
+  }
+
+  // Fills the pool of the current thread with count writers whose buffers
+  // have at least the given capacity.
+  static void prewarm(size_t count, size_t capacity)
+  {
+    std::vector<std::unique_ptr<Writer>>& free_writers = get_free_writers();
+    while (free_writers.size() < count && free_writers.size() < MAX_POOLED_WRITERS) {
+      free_writers.push_back(std::make_unique<Writer>());
+      free_writers.back()->reserve(capacity);
+    }
+  }
+
+  // Number of writers available in the pool of the current thread.
+  static size_t get_free_count() { return get_free_writers().size(); }
+
+private:
+  static std::vector<std::unique_ptr<Writer>>& get_free_writers()
+  {
+    thread_local std::vector<std::unique_ptr<Writer>> free_writers;
+    return free_writers;
+  }
+
+  static void release(std::unique_ptr<Writer> writer)
+  {
+    std::vector<std::unique_ptr<Writer>>& free_writers = get_free_writers();
+    if (free_writers.size() >= MAX_POOLED_WRITERS)
+      return;
+
+    writer->set_sink(nullptr);
+    writer->reset();
+    free_writers.push_back(std::move(writer));
+  }
+};
+
+inline JsonKey::JsonKey(std::string_view name)
+  : m_depends_on_escape_policy(json_detail::depends_on_escape_policy(name))
+{
+  CompactJsonWriter writer;
+  writer.begin_field(name);
+  m_quoted = writer.take_buffer();
+  if (m_depends_on_escape_policy)
+    m_name = name;
+}
+
+// Document skeleton recorded once, whose slots are then filled with new values
+// for each document. Keys, structure, indentation and colors are rendered
+// ahead of time, so filling only copies the static text between the slots and
+// formats the values, escaping strings with the policy of the writer:
+//   JsonWriter writer;
+//   writer.begin_object();
+//   writer.begin_field("id");
+//   writer.write_slot(JsonSlotKind::Integer);
+//   writer.end_field();
+//   writer.end_object();
+//   const JsonTemplate document(writer);
+//
+//   JsonTemplate::Filler filler = document.fill();
+//   filler.write_integer(42);
+//   std::string output = filler.finish();
+class JsonTemplate
+{
+public:
+  template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+  explicit JsonTemplate(const BasicJsonWriter<Pretty, Colored, Escape, Allocator>& writer)
+    : m_text(writer.get_buffer())
+    , m_slots(writer.get_slots())
+    , m_non_finite(writer.m_non_finite)
+    , m_append_string(Escape == JsonEscape::Default ? nullptr : &append_string<Escape>)
+  {
+  }
+
+  size_t get_slot_count() const { return m_slots.size(); }
+  JsonSlotKind get_slot_kind(size_t index) const { return m_slots[index].kind; }
+
+  // Fills the slots in order. Each value must match the kind of its slot,
+  // except null which may fill any slot. Misuse (a value of the wrong kind, more
+  // values than slots, or finish() before every slot is filled) throws
+  // std::logic_error, leaving the filler unchanged.
+  class Filler
+  {
+  public:
+    void write_null()
+    {
+      copy_to_next_slot(JsonSlotKind::Null);
+      m_writer.write_null();
+    }
+    void write_bool(bool value)
+    {
+      copy_to_next_slot(JsonSlotKind::Bool);
+      m_writer.write_bool(value);
+    }
+    void write_string(std::string_view value)
+    {
+      copy_to_next_slot(JsonSlotKind::String);
+      if (m_template.m_append_string != nullptr)
+        m_template.m_append_string(m_writer.m_buffer, value);
+      else
+        m_writer.write_string(value);
+    }
+    template<class T>
+    void write_integer(T value)
+    {
+      copy_to_next_slot(JsonSlotKind::Integer);
+      m_writer.write_integer(value);
+    }
+    template<class T>
+    void write_float(T value)
+    {
+      copy_to_next_slot(JsonSlotKind::Float);
+      m_writer.write_float(value);
+    }
+    template<class T>
+    void write_float(T value, int precision)
+    {
+      copy_to_next_slot(JsonSlotKind::Float);
+      m_writer.write_float(value, precision);
+    }
+
+    // Appends the rest of the document, once every slot is filled, and returns
+    // the output.
+    std::string finish()
+    {
+      if (m_slot_index != m_template.m_slots.size())
+        throw std::logic_error("JsonTemplate: not every slot is filled");
+      m_writer.m_buffer.append(m_template.m_text, m_text_offset, std::string::npos);
+      return m_writer.take_buffer();
+    }
+
+  private:
+    friend class JsonTemplate;
+
+    Filler(const JsonTemplate& document, std::string buffer)
+      : m_template(document)
+    {
+      m_writer.swap_buffer(buffer);
+      m_writer.reserve(document.m_text.size() + 16 * document.m_slots.size());
+      m_writer.set_non_finite(document.m_non_finite);
+    }
+
+    void copy_to_next_slot(JsonSlotKind kind)
+    {
+      if (m_slot_index == m_template.m_slots.size())
+        throw std::logic_error("JsonTemplate: more values than slots");
+      const JsonSlot& slot = m_template.m_slots[m_slot_index];
+      if (kind != JsonSlotKind::Null && kind != slot.kind)
+        throw std::logic_error("JsonTemplate: value of the wrong kind for its slot");
+
+      ++m_slot_index;
+      const size_t offset = slot.offset;
+      m_writer.m_buffer.append(m_template.m_text, m_text_offset, offset - m_text_offset);
+      m_text_offset = offset;
+    }
+
+    const JsonTemplate& m_template;
+    CompactJsonWriter m_writer;
+    size_t m_slot_index = 0;
+    size_t m_text_offset = 0;
+  };
+
+  // Starts filling a new document. The output is written into buffer, whose
+  // content is discarded, so that a buffer can be recycled between documents.
+  Filler fill(std::string buffer = std::string()) const { return Filler(*this, std::move(buffer)); }
+
+private:
+  // Appends value as a string escaped with the policy of the template.
+  template<JsonEscape Escape>
+  static void append_string(std::string& buffer, std::string_view value)
+  {
+    static thread_local BasicJsonWriter<JsonMode::Off, JsonMode::Off, Escape> writer;
+    writer.reset();
+    writer.write_string(value);
+    buffer.append(writer.get_buffer());
+  }
+
+  std::string m_text;
+  std::vector<JsonSlot> m_slots;
+  JsonNonFinite m_non_finite;
+  // Null for the default policy, which the filler writes itself.
+  void (*m_append_string)(std::string& buffer, std::string_view value);
+};
+
+// Records the calls of the writer API as a compact sequence of tokens, to be
+// rendered later by any number of writers, whatever their modes and colors:
+//   JsonTokenStream tokens;
+//   write_document(tokens);
+//   tokens.replay(compact_writer);
+//   tokens.replay(pretty_writer);
+// Strings and field names are escaped and numbers formatted when recorded, so
+// rendering mostly copies text. The few that another escape policy may change
+// are escaped again by the writers with that policy.
+class JsonTokenStream
+{
+public:
+  // Discards the recorded tokens, keeping the capacity.
+  void clear() { m_tokens.clear(); }
+  // Size in bytes of the recorded tokens.
+  size_t get_size() const { return m_tokens.size(); }
+
+  void begin_object() { m_tokens.push_back(BEGIN_OBJECT); }
+  void end_object() { m_tokens.push_back(END_OBJECT); }
+
+  void begin_array() { m_tokens.push_back(BEGIN_ARRAY); }
+  void end_array() { m_tokens.push_back(END_ARRAY); }
+
+  void begin_array_item() { m_tokens.push_back(BEGIN_ARRAY_ITEM); }
+  void end_array_item() { m_tokens.push_back(END_ARRAY_ITEM); }
+
+  void begin_field(std::string_view name)
+  {
+    m_formatter.reset();
+    m_formatter.begin_field(name);
+    push_text(BEGIN_FIELD, m_formatter.get_buffer(), name);
+  }
+  void begin_field(const JsonKey& key)
+  {
+    if (key.depends_on_escape_policy())
+      push_policy_text(POLICY_FIELD, key.get_quoted(), key.get_name());
+    else
+      push_text(BEGIN_FIELD, key.get_quoted());
+  }
+  void end_field() { m_tokens.push_back(END_FIELD); }
+
+  void write_null() { m_tokens.push_back(NULL_VALUE); }
+  void write_bool(bool value) { m_tokens.push_back(value ? TRUE_VALUE : FALSE_VALUE); }
+  void write_string(std::string_view value)
+  {
+    m_formatter.reset();
+    m_formatter.write_string(value);
+    push_text(STRING, m_formatter.get_buffer(), value);
+  }
+  template<class T>
+  void write_integer(T value)
+  {
+    m_formatter.reset();
+    m_formatter.write_integer(value);
+    push_text(NUMBER, m_formatter.get_buffer());
+  }
+  template<class T>
+  void write_float(T value)
+  {
+    if (!std::isfinite(value)) {
+      push_non_finite(value);
+      return;
+    }
+
+    m_formatter.reset();
+    m_formatter.write_float(value);
+    push_text(NUMBER, m_formatter.get_buffer());
+  }
+  template<class T>
+  void write_float(T value, int precision)
+  {
+    if (!std::isfinite(value)) {
+      push_non_finite(value);
+      return;
+    }
+
+    m_formatter.reset();
+    m_formatter.write_float(value, precision);
+    push_text(NUMBER, m_formatter.get_buffer());
+  }
+  void write_base64(const void* data, size_t size, JsonBase64 alphabet = JsonBase64::Standard)
+  {
+    m_formatter.reset();
+    m_formatter.write_base64(data, size, alphabet);
+    push_text(STRING, m_formatter.get_buffer());
+  }
+  template<class Container>
+  void write_base64(const Container& bytes, JsonBase64 alphabet = JsonBase64::Standard)
+  {
+    m_formatter.reset();
+    m_formatter.write_base64(bytes, alphabet);
+    push_text(STRING, m_formatter.get_buffer());
+  }
+
+  template<class Key>
+  void write_null_field(const Key& name)
+  {
+    begin_field(name);
+    write_null();
+    end_field();
+  }
+  template<class Key>
+  void write_bool_field(const Key& name, bool value)
+  {
+    begin_field(name);
+    write_bool(value);
+    end_field();
+  }
+  template<class Key>
+  void write_string_field(const Key& name, std::string_view value)
+  {
+    begin_field(name);
+    write_string(value);
+    end_field();
+  }
+  template<class Key, class T>
+  void write_integer_field(const Key& name, T value)
+  {
+    begin_field(name);
+    write_integer(value);
+    end_field();
+  }
+  template<class Key, class T>
+  void write_float_field(const Key& name, T value)
+  {
+    begin_field(name);
+    write_float(value);
+    end_field();
+  }
+  template<class Key, class T>
+  void write_float_field(const Key& name, T value, int precision)
+  {
+    begin_field(name);
+    write_float(value, precision);
+    end_field();
+  }
+  template<class Key>
+  void write_base64_field(const Key& name,
+                          const void* data,
+                          size_t size,
+                          JsonBase64 alphabet = JsonBase64::Standard)
+  {
+    begin_field(name);
+    write_base64(data, size, alphabet);
+    end_field();
+  }
+  template<class Key, class Container>
+  void write_base64_field(const Key& name, const Container& bytes, JsonBase64 alphabet = JsonBase64::Standard)
+  {
+    begin_field(name);
+    write_base64(bytes, alphabet);
+    end_field();
+  }
+
+  template<class It, class F>
+  void write_array(It begin, It end, F func)
+  {
+    begin_array();
+
+    for (auto it = begin; it != end; ++it) {
+      begin_array_item();
+      func(*this, *it);
+      end_array_item();
+    }
+
+    end_array();
+  }
+
+  // Renders the recorded tokens with writer, as if the calls were made on it.
+  template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+  void replay(BasicJsonWriter<Pretty, Colored, Escape, Allocator>& writer) const;
+
+private:
+  // Each token is a tag byte, followed for texts by their size as a base 128
+  // varint and their bytes, and for non-finite values by a double. Field names
+  // and strings that other escape policies may change are recorded as
+  // POLICY_FIELD and POLICY_STRING, whose text escaped with the default policy
+  // is followed by the unescaped one.
+  enum Token : char
+  {
+    BEGIN_OBJECT,
+    END_OBJECT,
+    BEGIN_ARRAY,
+    END_ARRAY,
+    BEGIN_ARRAY_ITEM,
+    END_ARRAY_ITEM,
+    BEGIN_FIELD,
+    END_FIELD,
+    NULL_VALUE,
+    TRUE_VALUE,
+    FALSE_VALUE,
+    STRING,
+    NUMBER,
+    NON_FINITE,
+    POLICY_FIELD,
+    POLICY_STRING,
+  };
+
+  void push_text(Token token, std::string_view text)
+  {
+    m_tokens.push_back(token);
+    append_text(text);
+  }
+  // Records a field name or string escaped as text from value.
+  void push_text(Token token, std::string_view text, std::string_view value)
+  {
+    if (json_detail::depends_on_escape_policy(value))
+      push_policy_text(token == BEGIN_FIELD ? POLICY_FIELD : POLICY_STRING, text, value);
+    else
+      push_text(token, text);
+  }
+  void push_policy_text(Token token, std::string_view text, std::string_view value)
+  {
+    push_text(token, text);
+    append_text(value);
+  }
+  void append_text(std::string_view text)
+  {
+    size_t size = text.size();
+    while (size >= 0x80) {
+      m_tokens.push_back(static_cast<char>(size | 0x80));
+      size >>= 7;
+    }
+    m_tokens.push_back(static_cast<char>(size));
+    m_tokens.append(text);
+  }
+
+  template<class T>
+  void push_non_finite(T value)
+  {
+    const double wide_value = static_cast<double>(value);
+    m_tokens.push_back(NON_FINITE);
+    const size_t old_size = m_tokens.size();
+    m_tokens.resize(old_size + sizeof(wide_value));
+    std::memcpy(&m_tokens[old_size], &wide_value, sizeof(wide_value));
+  }
+
+  static std::string_view read_text(const char*& it)
+  {
+    size_t size = 0;
+    int shift = 0;
+    unsigned char byte;
+    do {
+      byte = static_cast<unsigned char>(*it++);
+      size |= static_cast<size_t>(byte & 0x7F) << shift;
+      shift += 7;
+    } while (byte & 0x80);
+
+    const std::string_view text(it, size);
+    it += size;
+    return text;
+  }
+
+  std::string m_tokens;
+  // Formats the strings and numbers when they are recorded.
+  CompactJsonWriter m_formatter;
+};
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+JsonTokenStream::replay(BasicJsonWriter<Pretty, Colored, Escape, Allocator>& writer) const
+{
+  const char* it = m_tokens.data();
+  const char* end = it + m_tokens.size();
+  while (it != end) {
+    switch (static_cast<Token>(*it++)) {
+      case BEGIN_OBJECT:
+        writer.begin_object();
+        break;
+      case END_OBJECT:
+        writer.end_object();
+        break;
+      case BEGIN_ARRAY:
+        writer.begin_array();
+        break;
+      case END_ARRAY:
+        writer.end_array();
+        break;
+      case BEGIN_ARRAY_ITEM:
+        writer.begin_array_item();
+        break;
+      case END_ARRAY_ITEM:
+        writer.end_array_item();
+        break;
+      case BEGIN_FIELD:
+        writer.begin_quoted_field(read_text(it));
+        break;
+      case END_FIELD:
+        writer.end_field();
+        break;
+      case NULL_VALUE:
+        writer.write_null();
+        break;
+      case TRUE_VALUE:
+        writer.write_bool(true);
+        break;
+      case FALSE_VALUE:
+        writer.write_bool(false);
+        break;
+      case STRING:
+        writer.write_formatted(writer.m_colors.string, read_text(it));
+        break;
+      case NUMBER:
+        writer.write_formatted(writer.m_colors.number, read_text(it));
+        break;
+      case NON_FINITE: {
+        double value;
+        std::memcpy(&value, it, sizeof(value));
+        it += sizeof(value);
+        writer.write_float(value);
+        break;
+      }
+      case POLICY_FIELD: {
+        const std::string_view quoted_name = read_text(it);
+        const std::string_view name = read_text(it);
+        if constexpr (Escape == JsonEscape::Default)
+          writer.begin_quoted_field(quoted_name);
+        else
+          writer.begin_field(name);
+        break;
+      }
+      case POLICY_STRING: {
+        const std::string_view text = read_text(it);
+        const std::string_view value = read_text(it);
+        if constexpr (Escape == JsonEscape::Default)
+          writer.write_formatted(writer.m_colors.string, text);
+        else
+          writer.write_string(value);
+        break;
+      }
+    }
+  }
+}
+
+// Output stream of JSON Lines records shared by many producer threads. Each
+// thread formats its records with its own writer, then publishes them into a
+// bounded lock-free ring (Vyukov's MPMC queue, used with a single consumer)
+// without copying them. A background thread drains the ring in order and
+// hands the records to the sink in batches, so the records of a given thread
+// keep their order. Producers only wait when the ring is full.
+class JsonLogStream
+{
+public:
+  struct Stats
+  {
+    uint64_t records_written = 0;
+    // Number of records whose producer had to wait for the ring to drain.
+    uint64_t producer_waits = 0;
+  };
+
+  static constexpr size_t DEFAULT_CAPACITY = 1024;
+  // The drain thread hands the records to the sink once it has this many
+  // bytes, or when the ring is empty.
+  static constexpr size_t BATCH_SIZE = 64 * 1024;
+
+  // The capacity is rounded up to a power of two.
+  explicit JsonLogStream(JsonSink& sink, size_t capacity = DEFAULT_CAPACITY);
+  JsonLogStream(const JsonLogStream&) = delete;
+  JsonLogStream& operator=(const JsonLogStream&) = delete;
+  // Calls close().
+  ~JsonLogStream();
+
+  // Writes a record with func(writer), where writer is a CompactJsonWriter
+  // local to the calling thread, then publishes it. Thread-safe.
+  template<class F>
+  void write(F func)
+  {
+    CompactJsonWriter& writer = get_thread_writer();
+    writer.reset();
+    writer.begin_record();
+    func(writer);
+    writer.end_record();
+    publish(writer);
+  }
+
+  // Waits for the published records to be written and stops the drain thread.
+  // Nothing may be written afterwards.
+  void close();
+
+  Stats get_stats() const;
+
+private:
+  struct alignas(64) Slot
+  {
+    // Equal to the position of the slot when free and to the position plus
+    // one when it holds a record.
+    std::atomic<size_t> sequence;
+    std::string record;
+  };
+
+  static CompactJsonWriter& get_thread_writer()
+  {
+    thread_local CompactJsonWriter writer;
+    return writer;
+  }
+
+  void publish(CompactJsonWriter& writer);
+  void run();
+  void write_batch();
+
+  JsonSink& m_sink;
+  std::unique_ptr<Slot[]> m_slots;
+  size_t m_mask;
+  alignas(64) std::atomic<size_t> m_enqueue_position{ 0 };
+  alignas(64) std::atomic<uint64_t> m_producer_waits{ 0 };
+  // Only accessed by the drain thread, except for the counters.
+  alignas(64) size_t m_dequeue_position = 0;
+  std::atomic<uint64_t> m_records_written{ 0 };
+  std::string m_batch;
+  std::atomic<bool> m_stopping{ false };
+  std::thread m_thread;
+};
+
+namespace json_detail {
+// Escape policy of a writer.
+template<class Writer>
+struct WriterEscape : std::integral_constant<JsonEscape, JsonEscape::Default>
+{
+};
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+struct WriterEscape<BasicJsonWriter<Pretty, Colored, Escape, Allocator>> : std::integral_constant<JsonEscape, Escape>
+{
+};
+} // namespace json_detail
+
+// Cache of rendered JSON fragments shared by threads, for the parts of large
+// documents that rarely change. A fragment is keyed by the id of the object it
+// renders and the version of that object, and is rendered compact on a miss,
+// then spliced with write_raw_json():
+//   cache.write(writer, user.id, user.version, [&](auto& fragment_writer) {
+//     write_user(fragment_writer, user);
+//   });
+// Each id has at most one cached version, replaced by newer ones. The entries
+// are spread over shards, each with a reader-writer lock and its share of the
+// capacity, and evicted with the CLOCK algorithm: an entry hit since the last
+// sweep is kept once more.
+class JsonFragmentCache
+{
+public:
+  using Fragment = std::shared_ptr<const std::string>;
+
+  struct Stats
+  {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+  };
+
+  // In bytes of fragments.
+  static constexpr size_t DEFAULT_CAPACITY = 64 * 1024 * 1024;
+  static constexpr size_t SHARD_COUNT = 16;
+
+  explicit JsonFragmentCache(size_t capacity = DEFAULT_CAPACITY);
+  JsonFragmentCache(const JsonFragmentCache&) = delete;
+  JsonFragmentCache& operator=(const JsonFragmentCache&) = delete;
+
+  // Returns the fragment of id at version rendered with the escape policy, or
+  // null if it is not cached. A fragment is cached for one policy at a time.
+  Fragment find(uint64_t id, uint64_t version, JsonEscape escape = JsonEscape::Default) const;
+  // Stores json as the fragment of id at version, rendered with the escape
+  // policy, unless a newer version is cached, and returns it. json is made
+  // compact first if needed. Fragments larger than the capacity of a shard are
+  // not stored.
+  Fragment insert(uint64_t id, uint64_t version, std::string json, JsonEscape escape = JsonEscape::Default);
+  // Returns the fragment of id at version, rendered by render(writer) on a miss
+  // with a compact writer using the Escape policy, e.g. a CompactJsonWriter for
+  // the default one. render may use the cache for nested fragments. Threads
+  // missing the same fragment at the same time each render it.
+  template<JsonEscape Escape = JsonEscape::Default, class F>
+  Fragment get(uint64_t id, uint64_t version, F render)
+  {
+    if (Fragment fragment = find(id, version, Escape))
+      return fragment;
+
+    BasicJsonWriter<JsonMode::Off, JsonMode::Off, Escape> writer;
+    render(writer);
+    return insert(id, version, writer.take_buffer(), Escape);
+  }
+  // Writes the fragment of id at version with writer.write_raw_json(), after
+  // rendering it on a miss as get() does, with the escape policy of writer.
+  template<class Writer, class F>
+  void write(Writer& writer, uint64_t id, uint64_t version, F render)
+  {
+    const Fragment fragment = get<json_detail::WriterEscape<Writer>::value>(id, version, render);
+    // The fragments are compact, which spares scanning them.
+    writer.write_raw_json(*fragment, true);
+  }
+
+  void erase(uint64_t id);
+  void clear();
+
+  // Total size of the cached fragments.
+  size_t get_size() const;
+  Stats get_stats() const;
+
+private:
+  struct Entry
+  {
+    uint64_t version = 0;
+    JsonEscape escape = JsonEscape::Default;
+    Fragment json;
+    // Set by the hits, cleared by the CLOCK sweep.
+    mutable std::atomic<bool> is_referenced{ false };
+  };
+
+  struct alignas(64) Shard
+  {
+    mutable std::shared_mutex mutex;
+    std::unordered_map<uint64_t, Entry> entries;
+    // The ids in the order of the CLOCK sweep, possibly with erased ones.
+    std::deque<uint64_t> clock;
+    size_t size = 0;
+    mutable std::atomic<uint64_t> hits{ 0 };
+    mutable std::atomic<uint64_t> misses{ 0 };
+    uint64_t evictions = 0;
+  };
+
+  static size_t get_shard_index(uint64_t id)
+  {
+    // Fibonacci hashing, so that sequential ids are spread too.
+    return static_cast<size_t>((id * 0x9E3779B97F4A7C15u) >> 32) % SHARD_COUNT;
+  }
+
+  // Evicts entries other than keep_id until the shard fits in its capacity.
+  // The shard must be locked exclusively.
+  void evict(Shard& shard, uint64_t keep_id);
+
+  size_t m_shard_capacity;
+  Shard m_shards[SHARD_COUNT];
+};
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::reset()
+{
+#ifdef JSON_WRITER_ENABLE_STATS
+  if (m_stats_callback)
+    m_stats_callback(m_stats);
+  m_stats = JsonWriterStats();
+#endif
+  m_buffer.clear();
+  m_gather_refs.clear();
+  m_slots.clear();
+  m_has_invalid_utf8 = false;
+  m_indent_level = 0;
+  m_is_first_element = true;
+  if (m_in_record) {
+    m_pretty = m_record_saved_pretty;
+    m_in_record = false;
+  }
+  m_batch_records = 0;
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+typename BasicJsonWriter<Pretty, Colored, Escape, Allocator>::String
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::take_buffer()
+{
+  static_assert(!std::is_same_v<String, JsonSpanBuffer>, "the output of a span writer stays in its span");
+  String buffer = std::move(m_buffer);
+  // A new buffer on the same file would truncate it when closed.
+  if constexpr (json_detail::IsFileBuffer<String>::value)
+    m_buffer = String();
+  else
+    m_buffer = String(buffer.get_allocator());
+  reset();
+  return buffer;
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::swap_buffer(String& buffer)
+{
+  static_assert(!HAS_SPAN_BUFFER, "the output of a span writer stays in its span");
+  m_buffer.swap(buffer);
+  reset();
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+template<class T>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_integer_array(const T* values, size_t count)
+{
+  using Unsigned = typename json_detail::MakeUnsigned<T>::type;
+  using Wide = std::conditional_t<sizeof(Unsigned) <= sizeof(uint64_t), uint64_t, Unsigned>;
+  constexpr size_t MAX_SIZE = 2 + std::numeric_limits<Unsigned>::digits10;
+  const auto format = [](char* out, T value) {
+    const bool is_negative = json_detail::is_negative(value);
+    const Unsigned bits = static_cast<Unsigned>(value);
+    const Wide magnitude = is_negative ? static_cast<Unsigned>(Unsigned(0) - bits) : bits;
+    if (is_negative)
+      *out++ = '-';
+    out += json_detail::count_digits(magnitude);
+    json_detail::write_digits(out, magnitude);
+    return out;
+  };
+  const auto write_item = [](BasicJsonWriter& writer, T value) { writer.write_integer(value); };
+  write_number_array(values, count, MAX_SIZE, format, write_item);
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+template<class T>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_float_array(const T* values, size_t count)
+{
+  // Also large enough for the non-finite values, the longest being "-Infinity".
+  constexpr size_t MAX_SIZE =
+    5 + std::numeric_limits<T>::max_digits10 + std::max(2, log10ceil(std::numeric_limits<T>::max_exponent10));
+  const auto format = [this](char* out, T value) {
+    if (!std::isfinite(value))
+      return write_non_finite(out, value);
+    return std::to_chars(out, out + MAX_SIZE, value).ptr;
+  };
+  const auto write_item = [](BasicJsonWriter& writer, T value) { writer.write_float(value); };
+  write_number_array(values, count, MAX_SIZE, format, write_item);
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+template<class T, class F, class G>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_number_array(const T* values,
+                                                                        size_t count,
+                                                                        size_t max_size,
+                                                                        F format,
+                                                                        G write_item)
+{
+  if (use_colors()) {
+    // Colors are meant for terminals rather than throughput.
+    write_array(values, values + count, write_item);
+    return;
+  }
+
+  begin_array();
+
+  const size_t indent_size = is_pretty() ? 2 * m_indent_level : 0;
+  const size_t item_size = 1 + is_pretty() + indent_size + max_size;
+  // Formatted by blocks so that the output is handed to the sink regularly.
+  size_t block_size = 1024;
+  if constexpr (HAS_SPAN_BUFFER)
+    block_size = std::clamp<size_t>(JsonSpanBuffer::OVERFLOW_SCRATCH_SIZE / item_size, 1, block_size);
+  for (size_t i = 0; i < count;) {
+    const size_t block_end = std::min(count, i + block_size);
+    const size_t block_count = block_end - i;
+    // Separators and indentation are counted with the numbers.
+    StatsScope stats_scope(
+      *this, std::is_integral_v<T> ? &JsonWriterStats::integers : &JsonWriterStats::floats, block_count);
+    char* out = prepare_append(block_count * item_size);
+    for (; i < block_end; ++i) {
+      if (!m_is_first_element)
+        *out++ = ',';
+      m_is_first_element = false;
+      if (is_pretty()) {
+        *out++ = '\n';
+        out = std::fill_n(out, indent_size, ' ');
+      }
+      out = format(out, values[i]);
+    }
+    commit_append(out);
+#ifdef JSON_WRITER_ENABLE_STATS
+    if (is_pretty())
+      m_stats.indent_bytes += block_count * (1 + indent_size);
+#endif
+    flush_if_full();
+  }
+
+  end_array();
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+template<class It, class F>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_array_parallel(It begin,
+                                                                          It end,
+                                                                          F func,
+                                                                          unsigned thread_count)
+{
+  // Below this number of items per thread, spawning threads costs more than it
+  // saves.
+  constexpr size_t MIN_ITEMS_PER_THREAD = 64;
+
+  if constexpr (HAS_SPAN_BUFFER) {
+    // The span cannot be shared with the threads.
+    write_array(begin, end, func);
+    return;
+  }
+
+  if (thread_count == 0)
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  const size_t item_count = static_cast<size_t>(end - begin);
+  const size_t chunk_count = std::min<size_t>(thread_count, item_count / MIN_ITEMS_PER_THREAD);
+  if (chunk_count <= 1) {
+    write_array(begin, end, func);
+    return;
+  }
+
+  begin_array();
+
+  std::vector<BasicJsonWriter> fragments;
+  fragments.reserve(chunk_count);
+  for (size_t i = 0; i < chunk_count; ++i) {
+    // The fragments are filled concurrently, so they do not share the
+    // allocator of the writer, which may not be thread-safe (e.g. an arena).
+    fragments.push_back(make_fragment_writer(Allocator()));
+    // Only the first item of the array must not be preceded by a separator.
+    fragments.back().m_is_first_element = (i == 0);
+  }
+
+  std::vector<std::exception_ptr> errors(chunk_count);
+  const auto write_chunk = [&](size_t chunk) {
+    try {
+      BasicJsonWriter& fragment = fragments[chunk];
+      const It chunk_begin = begin + static_cast<std::ptrdiff_t>(item_count * chunk / chunk_count);
+      const It chunk_end = begin + static_cast<std::ptrdiff_t>(item_count * (chunk + 1) / chunk_count);
+      for (It it = chunk_begin; it != chunk_end; ++it) {
+        fragment.begin_array_item();
+        func(fragment, *it);
+        fragment.end_array_item();
+      }
+    } catch (...) {
+      errors[chunk] = std::current_exception();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(chunk_count - 1);
+  for (size_t i = 1; i < chunk_count; ++i)
+    threads.emplace_back(write_chunk, i);
+  write_chunk(0);
+  for (std::thread& thread : threads)
+    thread.join();
+
+  for (const std::exception_ptr& error : errors) {
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+  for (const BasicJsonWriter& fragment : fragments) {
+    m_buffer.append(fragment.m_buffer);
+    m_has_invalid_utf8 |= fragment.m_has_invalid_utf8;
+#ifdef JSON_WRITER_ENABLE_STATS
+    m_stats.merge(fragment.m_stats);
+#endif
+    flush_if_full();
+  }
+  m_is_first_element = false;
+
+  end_array();
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+template<class F>
+size_t
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::measure(F write) const
+{
+  if constexpr (HAS_SPAN_BUFFER) {
+    // A span writer without memory counts the size of its output.
+    BasicJsonWriter writer = make_fragment_writer(Allocator());
+    write(writer);
+    return writer.m_buffer.size();
+  }
+
+  JsonCountingSink sink;
+  BasicJsonWriter writer = make_fragment_writer(m_buffer.get_allocator());
+  writer.set_sink(&sink, MEASURE_BUFFER_SIZE);
+  write(writer);
+  writer.flush();
+  return sink.get_size();
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::make_fragment_writer(const Allocator& allocator) const
+{
+  BasicJsonWriter writer(allocator);
+  writer.m_colors = m_colors;
+  writer.m_indent_level = m_indent_level;
+  writer.m_is_first_element = m_is_first_element;
+  writer.m_non_finite = m_non_finite;
+  writer.m_use_colors = m_use_colors;
+  writer.m_pretty = m_pretty;
+  return writer;
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::begin_record()
+{
+  static_assert(Pretty != JsonMode::On, "records are always compact");
+  m_record_saved_pretty = m_pretty;
+  m_pretty = false;
+  m_in_record = true;
+  m_is_first_element = true;
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::end_record()
+{
+  m_buffer.push_back('\n');
+  m_pretty = m_record_saved_pretty;
+  m_in_record = false;
+  m_is_first_element = true;
+
+  if (m_sink != nullptr && (++m_batch_records >= m_max_batch_records || m_buffer.size() >= m_sink_buffer_size))
+    flush();
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_slot(JsonSlotKind kind)
+{
+  const char* color = m_colors.number;
+  switch (kind) {
+    case JsonSlotKind::Null:
+      color = m_colors.null;
+      break;
+    case JsonSlotKind::Bool:
+      color = m_colors.boolean;
+      break;
+    case JsonSlotKind::String:
+      color = m_colors.string;
+      break;
+    case JsonSlotKind::Integer:
+    case JsonSlotKind::Float:
+      break;
+  }
+
+  set_color(color);
+  m_slots.push_back({ m_buffer.size(), kind });
+  reset_color();
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::begin_object()
+{
+  StatsScope stats_scope(*this, &JsonWriterStats::structure);
+  m_buffer.push_back('{');
+  ++m_indent_level;
+  m_is_first_element = true;
+#ifdef JSON_WRITER_ENABLE_STATS
+  update_depth_stats();
+#endif
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::end_object()
+{
+  StatsScope stats_scope(*this, &JsonWriterStats::structure);
+  --m_indent_level;
+  write_closing_newline();
+  m_buffer.push_back('}');
+  m_is_first_element = false;
+  flush_if_full();
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::begin_array()
+{
+  StatsScope stats_scope(*this, &JsonWriterStats::structure);
+  m_buffer.push_back('[');
+  ++m_indent_level;
+  m_is_first_element = true;
+#ifdef JSON_WRITER_ENABLE_STATS
+  update_depth_stats();
+#endif
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::end_array()
+{
+  StatsScope stats_scope(*this, &JsonWriterStats::structure);
+  --m_indent_level;
+  write_closing_newline();
+  m_buffer.push_back(']');
+  m_is_first_element = false;
+  flush_if_full();
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::begin_array_item()
+{
+  StatsScope stats_scope(*this, &JsonWriterStats::structure);
+  write_separator();
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::end_array_item()
+{
+  flush_if_full();
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::begin_field(std::string_view name)
+{
+  StatsScope stats_scope(*this, &JsonWriterStats::field_names);
+  write_separator();
+
+  set_color(m_colors.field);
+  write_quoted_string(name);
+  m_buffer.push_back(':');
+  reset_color();
+
+  if (is_pretty())
+    m_buffer.push_back(' ');
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::begin_field(const JsonKey& key)
+{
+  if constexpr (Escape != JsonEscape::Default) {
+    if (key.depends_on_escape_policy()) {
+      begin_field(key.get_name());
+      return;
+    }
+  }
+  begin_quoted_field(key.get_quoted());
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::begin_quoted_field(std::string_view quoted_name)
+{
+  StatsScope stats_scope(*this, &JsonWriterStats::field_names);
+  write_separator();
+
+  set_color(m_colors.field);
+  m_buffer.append(quoted_name);
+  reset_color();
+
+  if (is_pretty())
+    m_buffer.push_back(' ');
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::end_field()
+{
+  flush_if_full();
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_null()
+{
+  StatsScope stats_scope(*this, &JsonWriterStats::nulls);
+  set_color(m_colors.null);
+  m_buffer.append("null");
+  reset_color();
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_bool(bool value)
+{
+  StatsScope stats_scope(*this, &JsonWriterStats::bools);
+  set_color(m_colors.boolean);
+  if (value)
+    m_buffer.append("true");
+  else
+    m_buffer.append("false");
+  reset_color();
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_string(std::string_view value)
+{
+  StatsScope stats_scope(*this, &JsonWriterStats::strings);
+  set_color(m_colors.string);
+  write_quoted_string(value);
+  reset_color();
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_base64(const void* data, size_t size, JsonBase64 alphabet)
+{
+  StatsScope stats_scope(*this, &JsonWriterStats::strings);
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  const bool url = alphabet == JsonBase64::Url;
+  // The base64 alphabets need no escaping under any policy.
+  set_color(m_colors.string);
+  m_buffer.push_back('"');
+  if constexpr (HAS_SPAN_BUFFER) {
+    // Encoded by blocks (multiples of 3 bytes, so without padding) that fit in
+    // the overflow scratch area.
+    constexpr size_t BLOCK_SIZE = JsonSpanBuffer::OVERFLOW_SCRATCH_SIZE / 4 * 3;
+    for (; size > BLOCK_SIZE; bytes += BLOCK_SIZE, size -= BLOCK_SIZE)
+      commit_append(json_detail::encode_base64(prepare_append(4 * BLOCK_SIZE / 3), bytes, BLOCK_SIZE, url));
+  }
+  commit_append(json_detail::encode_base64(prepare_append(json_detail::base64_size(size, !url)), bytes, size, url));
+  m_buffer.push_back('"');
+  reset_color();
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_string_ref(std::string_view value)
+{
+  if (!m_gather_mode || m_sink != nullptr || json_detail::IsFileBuffer<String>::value ||
+      value.size() < GATHER_MIN_SIZE ||
+      find_escape(value.data(), value.data() + value.size()) != value.data() + value.size()) {
+    write_string(value);
+    return;
+  }
+
+  StatsScope stats_scope(*this, &JsonWriterStats::strings);
+  set_color(m_colors.string);
+  m_buffer.push_back('"');
+  bool has_overflow = false;
+  if constexpr (HAS_SPAN_BUFFER)
+    has_overflow = m_buffer.has_overflow();
+  // A reference must point into the stored output, the rest is only counted.
+  if (has_overflow)
+    m_buffer.append(value);
+  else
+    m_gather_refs.push_back({ m_buffer.size(), value });
+  m_buffer.push_back('"');
+  reset_color();
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+std::vector<std::string_view>
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::get_segments() const
+{
+  std::vector<std::string_view> segments;
+  segments.reserve(2 * m_gather_refs.size() + 1);
+
+  const std::string_view buffer = m_buffer;
+  size_t offset = 0;
+  for (const GatherRef& ref : m_gather_refs) {
+    segments.push_back(buffer.substr(offset, ref.offset - offset));
+    segments.push_back(ref.data);
+    offset = ref.offset;
+  }
+  segments.push_back(buffer.substr(offset));
+
+  return segments;
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+size_t
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::get_output_size() const
+{
+  size_t size = m_buffer.size();
+  for (const GatherRef& ref : m_gather_refs)
+    size += ref.data.size();
+  return size;
+}
+
+#ifdef JSON_WRITER_HAS_POSIX
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+bool
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_segments(int fd) const
+{
+  const std::vector<std::string_view> segments = get_segments();
+  std::vector<iovec> vectors;
+  vectors.reserve(segments.size());
+  for (std::string_view segment : segments) {
+    if (!segment.empty())
+      vectors.push_back({ const_cast<char*>(segment.data()), segment.size() });
+  }
+
+  return json_detail::write_all(fd, vectors.data(), vectors.size());
+}
+#endif
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+template<class T>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_non_finite(T value)
+{
+  std::string_view literal;
+  if (std::isnan(value))
+    literal = "NaN";
+  else if (value > 0)
+    literal = "Infinity";
+  else
+    literal = "-Infinity";
+
+  switch (m_non_finite) {
+    case JsonNonFinite::Null:
+      write_null();
+      break;
+    case JsonNonFinite::String:
+      write_string(literal);
+      break;
+    case JsonNonFinite::Literal: {
+      StatsScope stats_scope(*this, &JsonWriterStats::floats);
+      set_color(m_colors.number);
+      m_buffer.append(literal);
+      reset_color();
+      break;
+    }
+  }
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+template<class T>
+char*
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_non_finite(char* out, T value) const
+{
+  std::string_view literal;
+  if (m_non_finite == JsonNonFinite::Null)
+    literal = "null";
+  else if (std::isnan(value))
+    literal = "NaN";
+  else if (value > 0)
+    literal = "Infinity";
+  else
+    literal = "-Infinity";
+
+  const bool is_quoted = m_non_finite == JsonNonFinite::String;
+  if (is_quoted)
+    *out++ = '"';
+  out = std::copy(literal.begin(), literal.end(), out);
+  if (is_quoted)
+    *out++ = '"';
+  return out;
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::set_color(const char* color)
+{
+  if (!use_colors())
+    return;
+
+#ifdef JSON_WRITER_ENABLE_STATS
+  const size_t old_size = m_buffer.size();
+#endif
+  m_buffer.append("\x1b[0;");
+  m_buffer.append(color);
+  m_buffer.append("m");
+#ifdef JSON_WRITER_ENABLE_STATS
+  m_stats.color_bytes += m_buffer.size() - old_size;
+#endif
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::reset_color()
+{
+  if (!use_colors())
+    return;
+
+  m_buffer.append("\x1b[0m");
+#ifdef JSON_WRITER_ENABLE_STATS
+  m_stats.color_bytes += 4;
+#endif
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_indent()
+{
+  if (!is_pretty())
+    return;
+
+  int indent_level = m_indent_level;
+  while (indent_level--) {
+    m_buffer.append("  ");
+  }
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_separator()
+{
+  // Only the innermost container needs to be tracked: once a nested container
+  // is closed, its parent has at least one element.
+  if (!m_is_first_element)
+    m_buffer.push_back(',');
+
+  if (is_pretty() && (m_indent_level > 0 || !m_is_first_element)) {
+    m_buffer.push_back('\n');
+    write_indent();
+#ifdef JSON_WRITER_ENABLE_STATS
+    m_stats.indent_bytes += 1 + 2 * m_indent_level;
+#endif
+  }
+
+  m_is_first_element = false;
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_closing_newline()
+{
+  if (!is_pretty())
+    return;
+
+  m_buffer.push_back('\n');
+  write_indent();
+#ifdef JSON_WRITER_ENABLE_STATS
+  m_stats.indent_bytes += 1 + 2 * m_indent_level;
+#endif
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_quoted_string(std::string_view value)
+{
+  m_buffer.reserve(m_buffer.size() + value.size() + 2);
+  m_buffer.push_back('"');
+
+  const char* it = value.data();
+  const char* end = it + value.size();
+  while (it != end) {
+    if (!needs_escape(*it)) {
+      // Bulk append the run of characters that do not need escaping.
+      const char* next = find_escape(it + 1, end);
+      m_buffer.append(it, next - it);
+      it = next;
+      continue;
+    }
+
+    if constexpr (VALIDATES_UTF8 && !has_escape_flag(JsonEscape::Ascii)) {
+      // Copy a valid sequence with the run of characters that follows it.
+      uint32_t code_point;
+      const int size = static_cast<unsigned char>(*it) >= 0x80 ? json_detail::decode_utf8(it, end, code_point) : 0;
+      if (size != 0) {
+        const char* next = find_escape(it + size, end);
+        m_buffer.append(it, next - it);
+        it = next;
+        continue;
+      }
+    }
+
+    // Special characters tend to be clustered, so escape a small block of
+    // characters through a raw pointer instead of rescanning after each one.
+    constexpr size_t BLOCK_SIZE = 32;
+    const char* block_end = static_cast<size_t>(end - it) > BLOCK_SIZE ? it + BLOCK_SIZE : end;
+    if constexpr (Escape == JsonEscape::Default) {
+      char* const begin = prepare_append(2 * (block_end - it));
+      char* out = begin;
+#ifdef JSON_WRITER_ENABLE_STATS
+      const size_t block_size = block_end - it;
+#endif
+      for (; it != block_end; ++it)
+        out = write_escaped_char(out, *it);
+      commit_append(out);
+#ifdef JSON_WRITER_ENABLE_STATS
+      // Each escaped character takes exactly one more byte.
+      m_stats.escaped_chars += (out - begin) - block_size;
+#endif
+    } else {
+      // A byte needs at most 6 characters (\u00XX), and the last UTF-8
+      // sequence may extend 3 bytes past the block.
+      char* out = prepare_append(6 * (block_end - it + 3));
+      while (it < block_end) {
+#ifdef JSON_WRITER_ENABLE_STATS
+        const char* const char_begin = it;
+        const char* const out_begin = out;
+#endif
+        if (VALIDATES_UTF8 && static_cast<unsigned char>(*it) >= 0x80)
+          out = write_escaped_utf8(out, it, end);
+        else
+          out = write_escaped_char(out, *it++);
+#ifdef JSON_WRITER_ENABLE_STATS
+        // Characters copied as is take the same size.
+        m_stats.escaped_chars += (out - out_begin) != (it - char_begin);
+#endif
+      }
+      commit_append(out);
+    }
+  }
+
+  m_buffer.push_back('"');
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_formatted(const char* color, std::string_view text)
+{
+  StatsScope stats_scope(*this, &JsonWriterStats::formatted);
+  set_color(color);
+  m_buffer.append(text);
+  reset_color();
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_raw_json(std::string_view json)
+{
+  const bool is_compact =
+    !use_colors() && !is_pretty() && json_detail::is_compact_json(json.data(), json.data() + json.size());
+  write_raw_json(json, is_compact);
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_raw_json(std::string_view json, bool is_compact)
+{
+  // Invalid input gives invalid output but is never read out of bounds.
+  if (use_colors()) {
+    // Colors are meant for terminals rather than throughput.
+    write_raw_value(json.data(), json.data() + json.size());
+    return;
+  }
+
+  StatsScope stats_scope(*this, &JsonWriterStats::formatted);
+  if (!is_pretty() && is_compact)
+    m_buffer.append(json);
+  else
+    reflow_raw_json(json);
+  m_is_first_element = false;
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::reflow_raw_json(std::string_view json)
+{
+  // Same layout as write_separator() and write_closing_newline().
+  int indent_level = m_indent_level;
+  const auto write_newline = [&] {
+    if (!is_pretty())
+      return;
+
+    // Appended by runs rather than by level.
+    static constexpr std::string_view SPACES = "                                ";
+    size_t size = 2 * static_cast<size_t>(std::max(indent_level, 0));
+#ifdef JSON_WRITER_ENABLE_STATS
+    m_stats.indent_bytes += 1 + size;
+#endif
+    m_buffer.push_back('\n');
+    for (; size > SPACES.size(); size -= SPACES.size())
+      m_buffer.append(SPACES);
+    m_buffer.append(SPACES.substr(0, size));
+  };
+
+  const char* it = json.data();
+  const char* end = it + json.size();
+  while ((it = json_detail::skip_json_whitespace(it, end)) != end) {
+    const char ch = *it;
+    switch (ch) {
+      case '{':
+      case '[':
+        m_buffer.push_back(ch);
+        it = json_detail::skip_json_whitespace(it + 1, end);
+        if (it != end && (*it == '}' || *it == ']')) {
+          write_newline();
+          m_buffer.push_back(*it++);
+        } else {
+          ++indent_level;
+          write_newline();
+        }
+        break;
+      case '}':
+      case ']':
+        --indent_level;
+        write_newline();
+        m_buffer.push_back(ch);
+        ++it;
+        break;
+      case ',':
+        m_buffer.push_back(',');
+        write_newline();
+        ++it;
+        break;
+      case ':':
+        m_buffer.push_back(':');
+        if (is_pretty())
+          m_buffer.push_back(' ');
+        ++it;
+        break;
+      default: {
+        const char* token_end = json_detail::find_json_token_end(it, end);
+        m_buffer.append(std::string_view(it, token_end - it));
+        it = token_end;
+        break;
+      }
+    }
+  }
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+const char*
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_raw_value(const char* it, const char* end)
+{
+  using json_detail::find_json_token_end;
+  using json_detail::skip_json_whitespace;
+
+  it = skip_json_whitespace(it, end);
+  if (it == end)
+    return it;
+
+  if (*it == '{' || *it == '[') {
+    const bool is_object = *it == '{';
+    const char closing = is_object ? '}' : ']';
+    if (is_object)
+      begin_object();
+    else
+      begin_array();
+
+    it = skip_json_whitespace(it + 1, end);
+    while (it != end && *it != closing) {
+      if (is_object) {
+        const char* name_end = std::max(find_json_token_end(it, end), it + 1);
+        const char* colon = skip_json_whitespace(name_end, end);
+        if (colon == name_end && colon != end && *colon == ':') {
+          // The name is usually followed by the colon, as expected by
+          // begin_quoted_field().
+          begin_quoted_field(std::string_view(it, colon + 1 - it));
+        } else {
+          std::string quoted_name(it, name_end);
+          quoted_name.push_back(':');
+          begin_quoted_field(quoted_name);
+        }
+        it = write_raw_value(colon != end && *colon == ':' ? colon + 1 : colon, end);
+        end_field();
+      } else {
+        begin_array_item();
+        it = write_raw_value(it, end);
+        end_array_item();
+      }
+
+      it = skip_json_whitespace(it, end);
+      if (it != end && *it == ',')
+        it = skip_json_whitespace(it + 1, end);
+    }
+
+    if (is_object)
+      end_object();
+    else
+      end_array();
+    return it == end ? it : it + 1;
+  }
+
+  // A stray structural character is consumed as a value so that the input
+  // always advances.
+  const char* token_end = std::max(find_json_token_end(it, end), it + 1);
+  const char* color = m_colors.number;
+  if (*it == '"')
+    color = m_colors.string;
+  else if (*it == 't' || *it == 'f')
+    color = m_colors.boolean;
+  else if (*it == 'n')
+    color = m_colors.null;
+  write_formatted(color, std::string_view(it, token_end - it));
+  return token_end;
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+char*
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_escaped_char(char* out, char ch)
+{
+  char escaped;
+  switch (ch) {
+    case '"':
+    case '\\':
+      escaped = ch;
+      break;
+    case '\n':
+      escaped = 'n';
+      break;
+    case '\r':
+      escaped = 'r';
+      break;
+    case '\t':
+      escaped = 't';
+      break;
+    case '\f':
+      escaped = 'f';
+      break;
+    case '\b':
+      if constexpr (!has_escape_flag(JsonEscape::Controls)) {
+        *out++ = ch;
+        return out;
+      }
+      escaped = 'b';
+      break;
+    default:
+      if ((has_escape_flag(JsonEscape::Controls) && static_cast<unsigned char>(ch) < 0x20) ||
+          (has_escape_flag(JsonEscape::Html) && (ch == '<' || ch == '>' || ch == '&')))
+        return write_unicode_escape(out, static_cast<unsigned char>(ch));
+      *out++ = ch;
+      return out;
+  }
+
+  *out++ = '\\';
+  *out++ = escaped;
+  return out;
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+char*
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_escaped_utf8(char* out, const char*& it, const char* end)
+{
+  uint32_t code_point;
+  const int size = json_detail::decode_utf8(it, end, code_point);
+  if (size == 0) {
+    ++it;
+    if constexpr (has_escape_flag(JsonEscape::RejectInvalidUtf8)) {
+      m_has_invalid_utf8 = true;
+      return out;
+    }
+
+    code_point = 0xFFFD;
+    if constexpr (!has_escape_flag(JsonEscape::Ascii))
+      return std::copy_n("\xEF\xBF\xBD", 3, out);
+  } else {
+    it += size;
+    if constexpr (!has_escape_flag(JsonEscape::Ascii))
+      return std::copy_n(it - size, size, out);
+  }
+
+  if (code_point >= 0x10000) {
+    code_point -= 0x10000;
+    out = write_unicode_escape(out, 0xD800 + (code_point >> 10));
+    code_point = 0xDC00 + (code_point & 0x3FF);
+  }
+  return write_unicode_escape(out, code_point);
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+char*
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::write_unicode_escape(char* out, uint32_t code_unit)
+{
+  constexpr char HEX_DIGITS[] = "0123456789abcdef";
+  *out++ = '\\';
+  *out++ = 'u';
+  for (int shift = 12; shift >= 0; shift -= 4)
+    *out++ = HEX_DIGITS[(code_unit >> shift) & 0xF];
+  return out;
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::set_sink(JsonSink* sink, size_t buffer_size)
+{
+  m_sink = sink;
+  m_sink_buffer_size = buffer_size;
+  if (m_sink != nullptr)
+    m_buffer.reserve(m_sink_buffer_size);
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::flush()
+{
+  if (m_sink == nullptr || m_buffer.empty())
+    return;
+  if constexpr (HAS_SPAN_BUFFER) {
+    // The output is incomplete, which is reported until the next reset.
+    if (m_buffer.has_overflow())
+      return;
+  }
+
+#ifdef JSON_WRITER_ENABLE_STATS
+  m_stats.peak_size = std::max(m_stats.peak_size, m_buffer.size());
+  m_stats.flushed_bytes += m_buffer.size();
+#endif
+  m_sink->write(m_buffer.data(), m_buffer.size());
+  m_buffer.clear();
+  m_batch_records = 0;
+}
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape, class Allocator>
+void
+BasicJsonWriter<Pretty, Colored, Escape, Allocator>::flush_if_full()
+{
+  if (m_sink != nullptr && m_buffer.size() >= m_sink_buffer_size && !m_in_record)
+    flush();
+}
+
+#ifdef JSON_WRITER_IMPLEMENTATION
+#if !defined(JSON_WRITER_NO_SIMD) &&                                                                                  \
+  (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define JSON_WRITER_HAS_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define JSON_WRITER_HAS_AVX2_DISPATCH
+#include <immintrin.h>
+#endif
+#endif
+
+#ifdef JSON_WRITER_HAS_POSIX
+#include <cerrno>
+#include <climits>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace json_detail {
+namespace {
+template<bool Html, bool NonAscii>
+const char*
+find_escape_scalar(const char* begin, const char* end)
+{
+  for (; begin != end; ++begin) {
+    if (needs_escape(*begin) || (Html && (*begin == '<' || *begin == '>' || *begin == '&')) ||
+        (NonAscii && static_cast<unsigned char>(*begin) >= 0x80))
+      return begin;
+  }
+
+  return end;
+}
+
+#ifdef JSON_WRITER_HAS_SSE2
+inline int
+count_trailing_zeros(unsigned mask)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+template<bool Html, bool NonAscii>
+const char*
+find_escape_sse2(const char* begin, const char* end)
+{
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i control_max = _mm_set1_epi8(0x1f);
+
+  for (; end - begin >= 16; begin += 16) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    // A byte is a control character iff max(byte, 0x1f) == 0x1f (unsigned).
+    const __m128i is_control = _mm_cmpeq_epi8(_mm_max_epu8(chunk, control_max), control_max);
+    __m128i is_special =
+      _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)), is_control);
+    if constexpr (Html) {
+      const __m128i is_html = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('<')),
+                                           _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('>')),
+                                                        _mm_cmpeq_epi8(chunk, _mm_set1_epi8('&'))));
+      is_special = _mm_or_si128(is_special, is_html);
+    }
+    // Non-ASCII bytes are the ones with the sign bit set.
+    if constexpr (NonAscii)
+      is_special = _mm_or_si128(is_special, chunk);
+    const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(is_special));
+    if (mask != 0)
+      return begin + count_trailing_zeros(mask);
+  }
+
+  return find_escape_scalar<Html, NonAscii>(begin, end);
+}
+#endif
+
+#ifdef JSON_WRITER_HAS_AVX2_DISPATCH
+template<bool Html, bool NonAscii>
+__attribute__((target("avx2"))) const char*
+find_escape_avx2(const char* begin, const char* end)
+{
+  const __m256i quote = _mm256_set1_epi8('"');
+  const __m256i backslash = _mm256_set1_epi8('\\');
+  const __m256i control_max = _mm256_set1_epi8(0x1f);
+
+  for (; end - begin >= 32; begin += 32) {
+    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    const __m256i is_control = _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, control_max), control_max);
+    __m256i is_special = _mm256_or_si256(
+      _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)), is_control);
+    if constexpr (Html) {
+      const __m256i is_html = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('<')),
+                                              _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('>')),
+                                                              _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('&'))));
+      is_special = _mm256_or_si256(is_special, is_html);
+    }
+    if constexpr (NonAscii)
+      is_special = _mm256_or_si256(is_special, chunk);
+    const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(is_special));
+    if (mask != 0)
+      return begin + count_trailing_zeros(mask);
+  }
+
+  return find_escape_sse2<Html, NonAscii>(begin, end);
+}
+#endif
+
+using FindEscapeFunc = const char* (*)(const char*, const char*);
+
+template<bool Html, bool NonAscii>
+FindEscapeFunc
+select_find_escape()
+{
+#if defined(JSON_WRITER_HAS_AVX2_DISPATCH)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return find_escape_avx2<Html, NonAscii>;
+  return find_escape_sse2<Html, NonAscii>;
+#elif defined(JSON_WRITER_HAS_SSE2)
+  return find_escape_sse2<Html, NonAscii>;
+#else
+  return find_escape_scalar<Html, NonAscii>;
+#endif
+}
+
+template<bool Html, bool NonAscii>
+const char*
+resolve_find_escape(const char* begin, const char* end);
+
+// Indexed by the classes of characters, see FIND_HTML and FIND_NON_ASCII. The
+// entries are constant-initialized to resolvers that select the implementation
+// on the first call and replace themselves, so that they work during static
+// initialization as well.
+std::atomic<FindEscapeFunc> find_escape_impls[] = {
+  resolve_find_escape<false, false>,
+  resolve_find_escape<true, false>,
+  resolve_find_escape<false, true>,
+  resolve_find_escape<true, true>,
+};
+
+template<bool Html, bool NonAscii>
+const char*
+resolve_find_escape(const char* begin, const char* end)
+{
+  const FindEscapeFunc impl = select_find_escape<Html, NonAscii>();
+  find_escape_impls[(Html ? FIND_HTML : 0u) | (NonAscii ? FIND_NON_ASCII : 0u)].store(impl,
+                                                                                        std::memory_order_relaxed);
+  return impl(begin, end);
+}
+
+const FindEscapeFunc find_escape_scalar_impls[] = {
+  find_escape_scalar<false, false>,
+  find_escape_scalar<true, false>,
+  find_escape_scalar<false, true>,
+  find_escape_scalar<true, true>,
+};
+} // namespace
+
+const char*
+find_escape(const char* begin, const char* end)
+{
+  // Short strings (typically field names) are not worth the dispatch.
+  if (end - begin < 16)
+    return find_escape_scalar<false, false>(begin, end);
+
+  return find_escape_impls[0].load(std::memory_order_relaxed)(begin, end);
+}
+
+const char*
+find_escape(const char* begin, const char* end, unsigned classes)
+{
+  if (end - begin < 16)
+    return find_escape_scalar_impls[classes](begin, end);
+
+  return find_escape_impls[classes].load(std::memory_order_relaxed)(begin, end);
+}
+
+namespace {
+template<bool Html>
+const char*
+find_escape_utf8_scalar(const char* begin, const char* end)
+{
+  constexpr unsigned CLASSES = (Html ? FIND_HTML : 0u) | FIND_NON_ASCII;
+  while (true) {
+    // ASCII runs are still skipped with the vectorized search.
+    begin = find_escape(begin, end, CLASSES);
+    if (begin == end || static_cast<unsigned char>(*begin) < 0x80)
+      return begin;
+
+    uint32_t code_point;
+    const int size = decode_utf8(begin, end, code_point);
+    if (size == 0)
+      return begin;
+    begin += size;
+  }
+}
+
+// Returns the position of the last lead byte among the 3 bytes before it,
+// where a sequence may start without having been fully validated, or it.
+const char*
+back_up_to_lead(const char* begin, const char* it)
+{
+  for (int i = 1; i <= 3 && it - i >= begin; ++i) {
+    const unsigned char byte = static_cast<unsigned char>(it[-i]);
+    if (byte >= 0xC0)
+      return it - i;
+    if (byte < 0x80)
+      break;
+  }
+
+  return it;
+}
+
+#ifdef JSON_WRITER_HAS_AVX2_DISPATCH
+// Returns the previous bytes of input, shifted by N bytes from previous.
+template<int N>
+__attribute__((target("avx2"))) inline __m256i
+shift_in_avx2(__m256i input, __m256i previous)
+{
+  return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(previous, input, 0x21), 16 - N);
+}
+
+__attribute__((target("avx2"))) inline __m256i
+lookup_avx2(__m256i indices, const __m256i& table)
+{
+  return _mm256_shuffle_epi8(table, indices);
+}
+
+// Vectorized UTF-8 validation by Keiser and Lemire, "Validating UTF-8 In Less
+// Than One Instruction Per Byte" (2021). Each byte is classified with three
+// lookups from the high and low nibbles of the previous byte and the high
+// nibble of the current one; the results are nonzero at invalid bytes.
+__attribute__((target("avx2"))) inline __m256i
+check_utf8_avx2(__m256i input, __m256i previous)
+{
+  constexpr char TOO_SHORT = 1 << 0;
+  constexpr char TOO_LONG = 1 << 1;
+  constexpr char OVERLONG_3 = 1 << 2;
+  constexpr char TOO_LARGE = 1 << 3;
+  constexpr char SURROGATE = 1 << 4;
+  constexpr char OVERLONG_2 = 1 << 5;
+  constexpr char TOO_LARGE_1000 = 1 << 6;
+  constexpr char OVERLONG_4 = 1 << 6;
+  constexpr char TWO_CONTS = static_cast<char>(1 << 7);
+  constexpr char CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+  const __m256i byte_1_high_table = _mm256_setr_epi8(
+    // First byte 0xxx, 10xx, 1100, 1101, 1110 and 1111.
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+    TWO_CONTS, TOO_SHORT | OVERLONG_2, TOO_SHORT, TOO_SHORT | OVERLONG_3 | SURROGATE,
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    TOO_LONG, TOO_LONG, TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS, TOO_SHORT | OVERLONG_2, TOO_SHORT,
+    TOO_SHORT | OVERLONG_3 | SURROGATE, TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4);
+  const __m256i byte_1_low_table = _mm256_setr_epi8(
+    // First byte xxxx0000 to xxxx1111.
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4, CARRY | OVERLONG_2, CARRY, CARRY, CARRY | TOO_LARGE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE, CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4, CARRY | OVERLONG_2, CARRY, CARRY,
+    CARRY | TOO_LARGE, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE, CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000);
+  const __m256i byte_2_high_table = _mm256_setr_epi8(
+    // Second byte 0xxx, 1000, 1001, 101x and 11xx.
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE, TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE, TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT);
+
+  const __m256i low_nibble_mask = _mm256_set1_epi8(0x0F);
+  const __m256i previous_1 = shift_in_avx2<1>(input, previous);
+  const __m256i byte_1_high =
+    lookup_avx2(_mm256_and_si256(_mm256_srli_epi16(previous_1, 4), low_nibble_mask), byte_1_high_table);
+  const __m256i byte_1_low = lookup_avx2(_mm256_and_si256(previous_1, low_nibble_mask), byte_1_low_table);
+  const __m256i byte_2_high =
+    lookup_avx2(_mm256_and_si256(_mm256_srli_epi16(input, 4), low_nibble_mask), byte_2_high_table);
+  const __m256i special_cases = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+  // Third and fourth bytes of 3 and 4 byte sequences must be continuations,
+  // which the lookups above flag as TWO_CONTS.
+  const __m256i is_third_byte = _mm256_subs_epu8(shift_in_avx2<2>(input, previous), _mm256_set1_epi8(0xE0 - 0x80));
+  const __m256i is_fourth_byte = _mm256_subs_epu8(shift_in_avx2<3>(input, previous), _mm256_set1_epi8(0xF0 - 0x80));
+  const __m256i must_be_continuation =
+    _mm256_and_si256(_mm256_or_si256(is_third_byte, is_fourth_byte), _mm256_set1_epi8(static_cast<char>(0x80)));
+  return _mm256_xor_si256(must_be_continuation, special_cases);
+}
+
+template<bool Html>
+__attribute__((target("avx2"))) const char*
+find_escape_utf8_avx2(const char* begin, const char* end)
+{
+  const __m256i quote = _mm256_set1_epi8('"');
+  const __m256i backslash = _mm256_set1_epi8('\\');
+  const __m256i control_max = _mm256_set1_epi8(0x1f);
+
+  const char* const start = begin;
+  __m256i previous = _mm256_setzero_si256();
+  for (; end - begin >= 32; begin += 32) {
+    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    const __m256i is_control = _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, control_max), control_max);
+    __m256i is_special = _mm256_or_si256(
+      _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)), is_control);
+    if constexpr (Html) {
+      const __m256i is_html = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('<')),
+                                              _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('>')),
+                                                              _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('&'))));
+      is_special = _mm256_or_si256(is_special, is_html);
+    }
+    const uint64_t special_mask = static_cast<unsigned>(_mm256_movemask_epi8(is_special));
+    const __m256i errors = check_utf8_avx2(chunk, previous);
+    const uint64_t error_mask =
+      ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(errors, _mm256_setzero_si256()))) & 0xFFFFFFFFu;
+    if ((special_mask | error_mask) != 0) {
+      // A special character is an ASCII character, so a sequence interrupted
+      // by it is reported at its position or before.
+      if (special_mask != 0) {
+        const int index = count_trailing_zeros(static_cast<unsigned>(special_mask));
+        if ((error_mask & ((uint64_t(2) << index) - 1)) == 0)
+          return begin + index;
+      }
+      break;
+    }
+    previous = chunk;
+  }
+
+  // The sequences starting in the last 3 bytes may not be fully validated yet.
+  return find_escape_utf8_scalar<Html>(back_up_to_lead(start, begin), end);
+}
+#endif
+
+using FindEscapeUtf8Func = const char* (*)(const char*, const char*);
+
+template<bool Html>
+FindEscapeUtf8Func
+select_find_escape_utf8()
+{
+#if defined(JSON_WRITER_HAS_AVX2_DISPATCH)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return find_escape_utf8_avx2<Html>;
+#endif
+  return find_escape_utf8_scalar<Html>;
+}
+
+template<bool Html>
+const char*
+resolve_find_escape_utf8(const char* begin, const char* end);
+
+// Resolved on the first call, as find_escape_impls.
+std::atomic<FindEscapeUtf8Func> find_escape_utf8_impls[] = {
+  resolve_find_escape_utf8<false>,
+  resolve_find_escape_utf8<true>,
+};
+
+template<bool Html>
+const char*
+resolve_find_escape_utf8(const char* begin, const char* end)
+{
+  const FindEscapeUtf8Func impl = select_find_escape_utf8<Html>();
+  find_escape_utf8_impls[Html].store(impl, std::memory_order_relaxed);
+  return impl(begin, end);
+}
+} // namespace
+
+const char*
+find_escape_utf8(const char* begin, const char* end, unsigned classes)
+{
+  return find_escape_utf8_impls[classes & FIND_HTML].load(std::memory_order_relaxed)(begin, end);
+}
+
+namespace {
+const char BASE64_STANDARD_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+const char BASE64_URL_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+template<bool Url>
+char*
+encode_base64_scalar(char* out, const unsigned char* data, size_t size)
+{
+  const char* const alphabet = Url ? BASE64_URL_ALPHABET : BASE64_STANDARD_ALPHABET;
+  for (; size >= 3; data += 3, size -= 3) {
+    const uint32_t bits = (uint32_t(data[0]) << 16) | (uint32_t(data[1]) << 8) | data[2];
+    *out++ = alphabet[bits >> 18];
+    *out++ = alphabet[(bits >> 12) & 0x3F];
+    *out++ = alphabet[(bits >> 6) & 0x3F];
+    *out++ = alphabet[bits & 0x3F];
+  }
+
+  if (size != 0) {
+    const uint32_t bits = (uint32_t(data[0]) << 16) | (size == 2 ? uint32_t(data[1]) << 8 : 0);
+    *out++ = alphabet[bits >> 18];
+    *out++ = alphabet[(bits >> 12) & 0x3F];
+    if (size == 2)
+      *out++ = alphabet[(bits >> 6) & 0x3F];
+    if constexpr (!Url)
+      out = std::fill_n(out, 3 - size, '=');
+  }
+
+  return out;
+}
+
+#ifdef JSON_WRITER_HAS_AVX2_DISPATCH
+// Vectorized encoding by Muła and Lemire, "Faster Base64 Encoding and Decoding
+// Using AVX2 Instructions" (2018). Each 32-bit lane receives 3 input bytes,
+// whose four 6-bit groups are moved to their own bytes with multiplications,
+// then translated to ASCII by adding an offset looked up from their range.
+__attribute__((target("ssse3"))) inline __m128i
+split_base64_ssse3(__m128i input)
+{
+  // Bytes 1, 0, 2, 1 of each group of 3, so that the groups are contiguous in
+  // the 16-bit halves.
+  input = _mm_shuffle_epi8(input, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+  const __m128i high = _mm_mulhi_epu16(_mm_and_si128(input, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+  const __m128i low = _mm_mullo_epi16(_mm_and_si128(input, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+  return _mm_or_si128(high, low);
+}
+
+template<bool Url>
+__attribute__((target("ssse3"))) inline __m128i
+translate_base64_ssse3(__m128i indices)
+{
+  // 0..25 map to 13, 26..51 to 0, 52..61 to 1..10, 62 to 11 and 63 to 12.
+  __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+  range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+  const __m128i offsets = _mm_setr_epi8('a' - 26,
+                                        '0' - 52,
+                                        '0' - 52,
+                                        '0' - 52,
+                                        '0' - 52,
+                                        '0' - 52,
+                                        '0' - 52,
+                                        '0' - 52,
+                                        '0' - 52,
+                                        '0' - 52,
+                                        '0' - 52,
+                                        (Url ? '-' : '+') - 62,
+                                        (Url ? '_' : '/') - 63,
+                                        'A',
+                                        0,
+                                        0);
+  return _mm_add_epi8(indices, _mm_shuffle_epi8(offsets, range));
+}
+
+template<bool Url>
+__attribute__((target("ssse3"))) char*
+encode_base64_ssse3(char* out, const unsigned char* data, size_t size)
+{
+  // 12 bytes are encoded per iteration, but 16 are loaded.
+  for (; size >= 16; data += 12, size -= 12, out += 16) {
+    const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), translate_base64_ssse3<Url>(split_base64_ssse3(input)));
+  }
+
+  return encode_base64_scalar<Url>(out, data, size);
+}
+
+__attribute__((target("avx2"))) inline __m256i
+split_base64_avx2(__m256i input)
+{
+  input = _mm256_shuffle_epi8(input,
+                              _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10, 1, 0, 2, 1, 4, 3, 5,
+                                               4, 7, 6, 8, 7, 10, 9, 11, 10));
+  const __m256i high =
+    _mm256_mulhi_epu16(_mm256_and_si256(input, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040));
+  const __m256i low =
+    _mm256_mullo_epi16(_mm256_and_si256(input, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010));
+  return _mm256_or_si256(high, low);
+}
+
+template<bool Url>
+__attribute__((target("avx2"))) inline __m256i
+translate_base64_avx2(__m256i indices)
+{
+  __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+  range =
+    _mm256_or_si256(range, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices), _mm256_set1_epi8(13)));
+  const __m256i offsets = _mm256_setr_epi8('a' - 26,
+                                           '0' - 52,
+                                           '0' - 52,
+                                           '0' - 52,
+                                           '0' - 52,
+                                           '0' - 52,
+                                           '0' - 52,
+                                           '0' - 52,
+                                           '0' - 52,
+                                           '0' - 52,
+                                           '0' - 52,
+                                           (Url ? '-' : '+') - 62,
+                                           (Url ? '_' : '/') - 63,
+                                           'A',
+                                           0,
+                                           0,
+                                           'a' - 26,
+                                           '0' - 52,
+                                           '0' - 52,
+                                           '0' - 52,
+                                           '0' - 52,
+                                           '0' - 52,
+                                           '0' - 52,
+                                           '0' - 52,
+                                           '0' - 52,
+                                           '0' - 52,
+                                           '0' - 52,
+                                           (Url ? '-' : '+') - 62,
+                                           (Url ? '_' : '/') - 63,
+                                           'A',
+                                           0,
+                                           0);
+  return _mm256_add_epi8(indices, _mm256_shuffle_epi8(offsets, range));
+}
+
+template<bool Url>
+__attribute__((target("avx2"))) char*
+encode_base64_avx2(char* out, const unsigned char* data, size_t size)
+{
+  // 24 bytes are encoded per iteration, 12 in each 128-bit lane, but 28 are
+  // loaded.
+  for (; size >= 28; data += 24, size -= 24, out += 32) {
+    const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 12));
+    const __m256i input = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), translate_base64_avx2<Url>(split_base64_avx2(input)));
+  }
+
+  return encode_base64_ssse3<Url>(out, data, size);
+}
+#endif
+
+using EncodeBase64Func = char* (*)(char*, const unsigned char*, size_t);
+
+template<bool Url>
+EncodeBase64Func
+select_encode_base64()
+{
+#if defined(JSON_WRITER_HAS_AVX2_DISPATCH)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return encode_base64_avx2<Url>;
+  if (__builtin_cpu_supports("ssse3"))
+    return encode_base64_ssse3<Url>;
+#endif
+  return encode_base64_scalar<Url>;
+}
+
+template<bool Url>
+char*
+resolve_encode_base64(char* out, const unsigned char* data, size_t size);
+
+// Resolved on the first call, as find_escape_impls.
+std::atomic<EncodeBase64Func> encode_base64_impls[] = {
+  resolve_encode_base64<false>,
+  resolve_encode_base64<true>,
+};
 
-class JsonWriter
+template<bool Url>
+char*
+resolve_encode_base64(char* out, const unsigned char* data, size_t size)
 {
-public:
-  struct Colors
-  {
-    const char* field = "36";
-    const char* string = "32";
-    const char* boolean = "31";
-    const char* null = "35";
-    const char* number = "33";
-  };
+  const EncodeBase64Func impl = select_encode_base64<Url>();
+  encode_base64_impls[Url].store(impl, std::memory_order_relaxed);
+  return impl(out, data, size);
+}
+} // namespace
 
-  const std::string& get_buffer() const { return m_buffer; }
+char*
+encode_base64(char* out, const unsigned char* data, size_t size, bool url)
+{
+  // Short values (typically hashes) are not worth the dispatch.
+  if (size < 16)
+    return url ? encode_base64_scalar<true>(out, data, size) : encode_base64_scalar<false>(out, data, size);
 
-  Colors& get_colors() { return m_colors; }
-  const Colors& get_colors() const { return m_colors; }
+  return encode_base64_impls[url].load(std::memory_order_relaxed)(out, data, size);
+}
+} // namespace json_detail
 
-  void set_use_colors(bool use_colors) { m_use_colors = use_colors; }
-  void set_pretty(bool pretty) { m_pretty = pretty; }
+#ifdef JSON_WRITER_HAS_POSIX
+namespace json_detail {
+bool
+write_all(int fd, iovec* vectors, size_t count)
+{
+#ifdef IOV_MAX
+  constexpr size_t MAX_VECTORS = IOV_MAX;
+#else
+  constexpr size_t MAX_VECTORS = 1024;
+#endif
 
-  void begin_object();
-  void end_object();
+  while (count > 0) {
+    const ssize_t written = ::writev(fd, vectors, static_cast<int>(std::min(count, MAX_VECTORS)));
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
 
-  void begin_array();
-  void end_array();
+    // Skip the buffers fully written and adjust the partially written one.
+    size_t remaining = static_cast<size_t>(written);
+    while (count > 0 && remaining >= vectors->iov_len) {
+      remaining -= vectors->iov_len;
+      ++vectors;
+      --count;
+    }
+    if (count > 0) {
+      vectors->iov_base = static_cast<char*>(vectors->iov_base) + remaining;
+      vectors->iov_len -= remaining;
+    }
+  }
 
-  void begin_array_item();
-  void end_array_item();
+  return true;
+}
+} // namespace json_detail
+#endif
 
-  void begin_field(std::string_view name);
-  void end_field();
+void
+JsonStringSink::write(const char* data, size_t size)
+{
+  m_output.append(data, size);
+}
 
-  void write_null();
-  void write_bool(bool value);
-  void write_string(std::string_view value);
-  template<class T>
-  void write_integer(T value)
-  {
-    constexpr size_t BUFFER_SIZE = std::numeric_limits<T>::digits10 + 1 + std::is_signed<T>::value;
-    char buffer[BUFFER_SIZE];
-    auto [ptr, ec] = std::to_chars(buffer, buffer + BUFFER_SIZE, value);
-    *ptr = '\0';
-    set_color(m_colors.number);
-    m_buffer.append(buffer);
-    reset_color();
-  }
-  template<class T>
-  void write_float(T value)
-  {
-    constexpr size_t BUFFER_SIZE =
-      5 + std::numeric_limits<T>::max_digits10 + std::max(2, log10ceil(std::numeric_limits<T>::max_exponent10));
-    char buffer[BUFFER_SIZE];
-    auto [ptr, ec] = std::to_chars(buffer, buffer + BUFFER_SIZE, value);
-    *ptr = '\0';
-    set_color(m_colors.number);
-    m_buffer.append(buffer);
-    reset_color();
-  }
+void
+JsonCountingSink::write(const char*, size_t size)
+{
+  m_size += size;
+}
 
-  void write_null_field(std::string_view name)
-  {
-    begin_field(name);
-    write_null();
-    end_field();
-  }
-  void write_bool_field(std::string_view name, bool value)
-  {
-    begin_field(name);
-    write_bool(value);
-    end_field();
-  }
-  void write_string_field(std::string_view name, std::string_view value)
-  {
-    begin_field(name);
-    write_string(value);
-    end_field();
-  }
-  template<class T>
-  void write_integer_field(std::string_view name, T value)
-  {
-    begin_field(name);
-    write_integer(value);
-    end_field();
-  }
-  template<class T>
-  void write_float_field(std::string_view name, T value)
-  {
-    begin_field(name);
-    write_float(value);
-    end_field();
+void
+JsonFileSink::write(const char* data, size_t size)
+{
+  if (std::fwrite(data, 1, size, m_file) != size)
+    m_has_error = true;
+}
+
+#ifdef JSON_WRITER_HAS_POSIX
+void
+JsonFdSink::write(const char* data, size_t size)
+{
+  while (size > 0) {
+    const ssize_t written = ::write(m_fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      m_has_error = true;
+      return;
+    }
+
+    data += written;
+    size -= static_cast<size_t>(written);
   }
+}
 
-  template<class It, class F>
-  void write_array(It begin, It end, F func)
-  {
-    begin_array();
+JsonMmapFileBuffer::JsonMmapFileBuffer(const JsonMmapFile& file)
+  : m_file(file)
+  , m_is_open(file.get_fd() >= 0)
+{
+  set_grow_func(&JsonMmapFileBuffer::grow);
+}
 
-    for (auto it = begin; it != end; ++it) {
-      begin_array_item();
-      func(*this, *it);
-      end_array_item();
-    }
+JsonMmapFileBuffer::JsonMmapFileBuffer(JsonMmapFileBuffer&& other) noexcept
+  : JsonSpanBuffer(other)
+  , m_file(other.m_file)
+  , m_is_open(std::exchange(other.m_is_open, false))
+  , m_has_error(other.m_has_error)
+{
+  other.set_storage(nullptr, 0);
+  other.clear();
+}
 
-    end_array();
+JsonMmapFileBuffer&
+JsonMmapFileBuffer::operator=(JsonMmapFileBuffer&& other) noexcept
+{
+  if (this != &other) {
+    close();
+    JsonSpanBuffer::operator=(other);
+    m_file = other.m_file;
+    m_is_open = std::exchange(other.m_is_open, false);
+    m_has_error = other.m_has_error;
+    other.set_storage(nullptr, 0);
+    other.clear();
   }
+  return *this;
+}
 
-private:
-  template<typename T>
-  static constexpr int log10ceil(T num)
-  {
-    return num < 10 ? 1 : 1 + log10ceil(num / 10);
+JsonMmapFileBuffer::~JsonMmapFileBuffer()
+{
+  close();
+}
+
+bool
+JsonMmapFileBuffer::close()
+{
+  if (!m_is_open)
+    return !m_has_error;
+
+  m_is_open = false;
+  // Only the stored output is kept if the file could not grow.
+  const size_t size = view().size();
+  if (get_storage() != nullptr && munmap(get_storage(), capacity()) != 0)
+    m_has_error = true;
+  set_storage(nullptr, 0);
+  clear();
+  if (ftruncate(m_file.get_fd(), static_cast<off_t>(size)) != 0)
+    m_has_error = true;
+  return !m_has_error;
+}
+
+bool
+JsonMmapFileBuffer::grow(JsonSpanBuffer& buffer, size_t min_capacity)
+{
+  JsonMmapFileBuffer& self = static_cast<JsonMmapFileBuffer&>(buffer);
+  if (!self.m_is_open || self.m_has_error)
+    return false;
+  if (!self.map(min_capacity)) {
+    self.m_has_error = true;
+    return false;
   }
+  return true;
+}
 
-  void set_color(const char* color);
-  void reset_color();
+bool
+JsonMmapFileBuffer::map(size_t min_capacity)
+{
+  const size_t chunk_size = std::max<size_t>(m_file.get_chunk_size(), sysconf(_SC_PAGESIZE));
+  const size_t new_capacity = (min_capacity + chunk_size - 1) / chunk_size * chunk_size;
+  if (ftruncate(m_file.get_fd(), static_cast<off_t>(new_capacity)) != 0)
+    return false;
 
-  void write_indent();
-  void write_comma();
-  void write_quoted_string(std::string_view value);
+  void* data;
+  if (get_storage() == nullptr) {
+    data = mmap(nullptr, new_capacity, PROT_READ | PROT_WRITE, MAP_SHARED, m_file.get_fd(), 0);
+  } else {
+#ifdef MREMAP_MAYMOVE
+    // The previous mapping is kept on failure.
+    data = mremap(get_storage(), capacity(), new_capacity, MREMAP_MAYMOVE);
+#else
+    // The output already written is kept by the file.
+    munmap(get_storage(), capacity());
+    set_storage(nullptr, 0);
+    data = mmap(nullptr, new_capacity, PROT_READ | PROT_WRITE, MAP_SHARED, m_file.get_fd(), 0);
+#endif
+  }
 
-  void remove_trailing_comma();
+  if (data == MAP_FAILED)
+    return false;
 
-private:
-  std::string m_buffer;
-  Colors m_colors;
-  int m_indent_level = 0;
-  bool m_use_colors = false;
-  bool m_pretty = true;
-};
+  set_storage(static_cast<char*>(data), new_capacity);
+#ifdef MADV_SEQUENTIAL
+  if (m_file.is_sequential())
+    madvise(data, new_capacity, MADV_SEQUENTIAL);
+#endif
+  return true;
+}
+#endif
 
-#ifdef JSON_WRITER_IMPLEMENTATION
 void
-JsonWriter::begin_object()
+JsonCallbackSink::write(const char* data, size_t size)
 {
-  m_buffer.push_back('{');
-  if (m_pretty)
-    m_buffer.push_back('\n');
-  ++m_indent_level;
+  m_callback(std::string_view(data, size));
 }
 
-void
-JsonWriter::end_object()
+JsonAsyncFileSink::JsonAsyncFileSink(FILE* file, size_t buffer_count, size_t buffer_size)
+  : m_file(file)
+  , m_buffer_size(buffer_size)
 {
-  remove_trailing_comma();
+  // One buffer is owned by the producer, the others are free.
+  m_current_buffer.reserve(m_buffer_size);
+  for (size_t i = 1; i < std::max<size_t>(buffer_count, 2); ++i) {
+    m_free_buffers.emplace_back();
+    m_free_buffers.back().reserve(m_buffer_size);
+  }
 
-  --m_indent_level;
-  write_indent();
-  m_buffer.push_back('}');
+  m_thread = std::thread(&JsonAsyncFileSink::run, this);
 }
 
-void
-JsonWriter::begin_array()
+JsonAsyncFileSink::~JsonAsyncFileSink()
 {
-  m_buffer.push_back('[');
-  if (m_pretty)
-    m_buffer.push_back('\n');
-  ++m_indent_level;
+  close();
 }
 
 void
-JsonWriter::end_array()
+JsonAsyncFileSink::write(const char* data, size_t size)
 {
-  remove_trailing_comma();
+  while (size > 0) {
+    const size_t chunk_size = std::min(size, m_buffer_size - m_current_buffer.size());
+    m_current_buffer.append(data, chunk_size);
+    data += chunk_size;
+    size -= chunk_size;
 
-  --m_indent_level;
-  write_indent();
-  m_buffer.push_back(']');
+    if (m_current_buffer.size() >= m_buffer_size)
+      submit_current_buffer();
+  }
 }
 
 void
-JsonWriter::begin_array_item()
+JsonAsyncFileSink::flush()
 {
-  write_indent();
+  if (!m_current_buffer.empty())
+    submit_current_buffer();
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_producer_condition.wait(lock, [this] { return m_pending_buffers.empty() && m_writing_count == 0; });
+  if (std::fflush(m_file) != 0)
+    m_has_error = true;
 }
 
 void
-JsonWriter::end_array_item()
+JsonAsyncFileSink::close()
+{
+  if (!m_thread.joinable())
+    return;
+
+  flush();
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_writer_condition.notify_one();
+  m_thread.join();
+}
+
+JsonAsyncFileSink::Stats
+JsonAsyncFileSink::get_stats() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+bool
+JsonAsyncFileSink::has_error() const
 {
-  write_comma();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_has_error;
 }
 
 void
-JsonWriter::begin_field(std::string_view name)
+JsonAsyncFileSink::submit_current_buffer()
 {
-  write_indent();
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_pending_buffers.push_back(std::move(m_current_buffer));
+  m_writer_condition.notify_one();
 
-  set_color(m_colors.field);
-  write_quoted_string(name);
-  m_buffer.push_back(':');
-  reset_color();
+  if (m_free_buffers.empty()) {
+    ++m_stats.producer_waits;
+    m_producer_condition.wait(lock, [this] { return !m_free_buffers.empty(); });
+  }
 
-  if (m_pretty)
-    m_buffer.push_back(' ');
+  m_current_buffer = std::move(m_free_buffers.back());
+  m_free_buffers.pop_back();
 }
 
 void
-JsonWriter::end_field()
+JsonAsyncFileSink::run()
 {
-  write_comma();
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    m_writer_condition.wait(lock, [this] { return !m_pending_buffers.empty() || m_stopping; });
+    if (m_pending_buffers.empty())
+      return;
+
+    std::string buffer = std::move(m_pending_buffers.front());
+    m_pending_buffers.pop_front();
+    ++m_writing_count;
+
+    lock.unlock();
+    const bool success = std::fwrite(buffer.data(), 1, buffer.size(), m_file) == buffer.size();
+    lock.lock();
+
+    --m_writing_count;
+    m_stats.bytes_written += buffer.size();
+    ++m_stats.buffers_written;
+    if (!success)
+      m_has_error = true;
+
+    buffer.clear();
+    m_free_buffers.push_back(std::move(buffer));
+    m_producer_condition.notify_all();
+  }
 }
 
-void
-JsonWriter::write_null()
+JsonLogStream::JsonLogStream(JsonSink& sink, size_t capacity)
+  : m_sink(sink)
 {
-  set_color(m_colors.null);
-  m_buffer.append("null");
-  reset_color();
+  size_t slot_count = 2;
+  while (slot_count < capacity)
+    slot_count *= 2;
+  m_mask = slot_count - 1;
+
+  m_slots.reset(new Slot[slot_count]);
+  for (size_t i = 0; i < slot_count; ++i)
+    m_slots[i].sequence.store(i, std::memory_order_relaxed);
+  m_batch.reserve(BATCH_SIZE);
+
+  m_thread = std::thread(&JsonLogStream::run, this);
 }
 
-void
-JsonWriter::write_bool(bool value)
+JsonLogStream::~JsonLogStream()
 {
-  set_color(m_colors.boolean);
-  if (value)
-    m_buffer.append("true");
-  else
-    m_buffer.append("false");
-  reset_color();
+  close();
 }
 
 void
-JsonWriter::write_string(std::string_view value)
+JsonLogStream::close()
 {
-  set_color(m_colors.string);
-  write_quoted_string(value);
-  reset_color();
+  if (!m_thread.joinable())
+    return;
+
+  m_stopping.store(true, std::memory_order_release);
+  m_thread.join();
+}
+
+JsonLogStream::Stats
+JsonLogStream::get_stats() const
+{
+  Stats stats;
+  stats.records_written = m_records_written.load(std::memory_order_relaxed);
+  stats.producer_waits = m_producer_waits.load(std::memory_order_relaxed);
+  return stats;
 }
 
 void
-JsonWriter::set_color(const char* color)
+JsonLogStream::publish(CompactJsonWriter& writer)
 {
-  if (!m_use_colors)
-    return;
+  size_t position = m_enqueue_position.load(std::memory_order_relaxed);
+  bool has_waited = false;
+  Slot* slot;
+  while (true) {
+    slot = &m_slots[position & m_mask];
+    const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    const ptrdiff_t difference = static_cast<ptrdiff_t>(sequence - position);
+    if (difference == 0) {
+      // The slot is free: try to claim its position.
+      if (m_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+        break;
+    } else if (difference < 0) {
+      // The ring is full.
+      if (!has_waited) {
+        m_producer_waits.fetch_add(1, std::memory_order_relaxed);
+        has_waited = true;
+      }
+      std::this_thread::yield();
+      position = m_enqueue_position.load(std::memory_order_relaxed);
+    } else {
+      // Another producer claimed this position.
+      position = m_enqueue_position.load(std::memory_order_relaxed);
+    }
+  }
 
-  m_buffer.append("\x1b[0;");
-  m_buffer.append(color);
-  m_buffer.append("m");
+  // The writer takes the previous record of the slot as its new buffer, so the
+  // buffers circulate without allocation.
+  writer.swap_buffer(slot->record);
+  slot->sequence.store(position + 1, std::memory_order_release);
 }
 
 void
-JsonWriter::reset_color()
+JsonLogStream::run()
 {
-  if (!m_use_colors)
-    return;
+  int idle_count = 0;
+  while (true) {
+    Slot& slot = m_slots[m_dequeue_position & m_mask];
+    if (slot.sequence.load(std::memory_order_acquire) == m_dequeue_position + 1) {
+      m_batch.append(slot.record);
+      slot.sequence.store(m_dequeue_position + m_mask + 1, std::memory_order_release);
+      ++m_dequeue_position;
+      m_records_written.fetch_add(1, std::memory_order_relaxed);
+      if (m_batch.size() >= BATCH_SIZE)
+        write_batch();
+      idle_count = 0;
+      continue;
+    }
 
-  m_buffer.append("\x1b[0m");
+    write_batch();
+    // Checked before the last look at the ring, so that a record published
+    // before close() is never missed.
+    const bool is_stopping = m_stopping.load(std::memory_order_acquire);
+    if (is_stopping && m_dequeue_position == m_enqueue_position.load(std::memory_order_acquire))
+      return;
+
+    // Spin briefly, then sleep, while the ring is empty.
+    if (++idle_count < 64) {
+      std::this_thread::yield();
+    } else {
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+  }
 }
 
 void
-JsonWriter::write_indent()
+JsonLogStream::write_batch()
 {
-  if (!m_pretty)
+  if (m_batch.empty())
     return;
 
-  int indent_level = m_indent_level;
-  while (indent_level--) {
-    m_buffer.append("  ");
+  m_sink.write(m_batch.data(), m_batch.size());
+  m_batch.clear();
+}
+
+JsonFragmentCache::JsonFragmentCache(size_t capacity)
+  : m_shard_capacity(capacity / SHARD_COUNT)
+{
+}
+
+JsonFragmentCache::Fragment
+JsonFragmentCache::find(uint64_t id, uint64_t version, JsonEscape escape) const
+{
+  const Shard& shard = m_shards[get_shard_index(id)];
+  std::shared_lock<std::shared_mutex> lock(shard.mutex);
+  const auto it = shard.entries.find(id);
+  if (it == shard.entries.end() || it->second.version != version || it->second.escape != escape) {
+    shard.misses.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
   }
+
+  // Checked first to avoid writing to a shared cache line on every hit.
+  if (!it->second.is_referenced.load(std::memory_order_relaxed))
+    it->second.is_referenced.store(true, std::memory_order_relaxed);
+  shard.hits.fetch_add(1, std::memory_order_relaxed);
+  return it->second.json;
 }
 
-void
-JsonWriter::write_comma()
+JsonFragmentCache::Fragment
+JsonFragmentCache::insert(uint64_t id, uint64_t version, std::string json, JsonEscape escape)
 {
-  m_buffer.push_back(',');
-  if (m_pretty)
-    m_buffer.push_back('\n');
+  if (!json_detail::is_compact_json(json.data(), json.data() + json.size())) {
+    CompactJsonWriter writer;
+    writer.write_raw_json(json);
+    json = writer.take_buffer();
+  }
+
+  const size_t size = json.size();
+  Fragment fragment = std::make_shared<const std::string>(std::move(json));
+
+  Shard& shard = m_shards[get_shard_index(id)];
+  std::unique_lock<std::shared_mutex> lock(shard.mutex);
+  auto it = shard.entries.find(id);
+  if (it != shard.entries.end() && it->second.version > version)
+    return fragment;
+
+  if (size > m_shard_capacity) {
+    // The cached version is outdated anyway.
+    if (it != shard.entries.end()) {
+      shard.size -= it->second.json->size();
+      shard.entries.erase(it);
+    }
+    return fragment;
+  }
+
+  if (it == shard.entries.end()) {
+    it = shard.entries.try_emplace(id).first;
+    shard.clock.push_back(id);
+  } else {
+    shard.size -= it->second.json->size();
+  }
+  it->second.version = version;
+  it->second.escape = escape;
+  it->second.json = fragment;
+  shard.size += size;
+  evict(shard, id);
+  return fragment;
 }
 
 void
-JsonWriter::write_quoted_string(std::string_view value)
+JsonFragmentCache::evict(Shard& shard, uint64_t keep_id)
 {
-  m_buffer.append("\"");
+  while (shard.size > m_shard_capacity) {
+    const uint64_t id = shard.clock.front();
+    shard.clock.pop_front();
+    const auto it = shard.entries.find(id);
+    if (it == shard.entries.end())
+      continue;
 
-  for (size_t i = 0; i < value.size(); ++i) {
-    const char ch = value[i];
-    switch (ch) {
-      case '"':
-        m_buffer.append("\\\"");
-        break;
-      case '\\':
-        m_buffer.append("\\\\");
-        break;
-      case '\n':
-        m_buffer.append("\\n");
-        break;
-      case '\r':
-        m_buffer.append("\\r");
-        break;
-      case '\t':
-        m_buffer.append("\\t");
-        break;
-      case '\f':
-        m_buffer.append("\\f");
-        break;
-      default:
-        m_buffer.push_back(ch);
+    if (id == keep_id || it->second.is_referenced.exchange(false, std::memory_order_relaxed)) {
+      shard.clock.push_back(id);
+      continue;
     }
+
+    shard.size -= it->second.json->size();
+    shard.entries.erase(it);
+    ++shard.evictions;
   }
+}
+
+void
+JsonFragmentCache::erase(uint64_t id)
+{
+  Shard& shard = m_shards[get_shard_index(id)];
+  std::unique_lock<std::shared_mutex> lock(shard.mutex);
+  const auto it = shard.entries.find(id);
+  if (it == shard.entries.end())
+    return;
 
-  m_buffer.append("\"");
+  shard.size -= it->second.json->size();
+  shard.entries.erase(it);
+  // The erased ids are left in the clock until the sweep reaches them, unless
+  // they pile up.
+  if (shard.clock.size() > 2 * shard.entries.size() + 64) {
+    shard.clock.clear();
+    for (const auto& entry : shard.entries)
+      shard.clock.push_back(entry.first);
+  }
 }
 
 void
-JsonWriter::remove_trailing_comma()
+JsonFragmentCache::clear()
+{
+  for (Shard& shard : m_shards) {
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.entries.clear();
+    shard.clock.clear();
+    shard.size = 0;
+  }
+}
+
+size_t
+JsonFragmentCache::get_size() const
+{
+  size_t size = 0;
+  for (const Shard& shard : m_shards) {
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    size += shard.size;
+  }
+  return size;
+}
+
+JsonFragmentCache::Stats
+JsonFragmentCache::get_stats() const
 {
-  if (m_buffer.size() > 2 && m_buffer[m_buffer.size() - 2] == ',' && m_buffer[m_buffer.size() - 1] == '\n') {
-    m_buffer.resize(m_buffer.size() - 1);
-    m_buffer[m_buffer.size() - 1] = '\n';
-  } else if (m_buffer.size() > 2 && m_buffer[m_buffer.size() - 1] == ',') {
-    m_buffer.resize(m_buffer.size() - 1);
+  Stats stats;
+  for (const Shard& shard : m_shards) {
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    stats.hits += shard.hits.load(std::memory_order_relaxed);
+    stats.misses += shard.misses.load(std::memory_order_relaxed);
+    stats.evictions += shard.evictions;
   }
+  return stats;
 }
+
 #endif
 
 #endif
@@ -0,0 +1,190 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "json_writer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace {
+template<class Writer>
+void
+write_document(Writer& writer)
+{
+  writer.begin_object();
+  writer.write_string_field("name", "Alice \"A\"");
+  writer.begin_field("values");
+  writer.begin_array();
+  for (int i = 0; i < 100; ++i) {
+    writer.begin_array_item();
+    writer.write_integer(i);
+    writer.end_array_item();
+  }
+  writer.end_array();
+  writer.end_field();
+  writer.end_object();
+}
+
+// Counts the allocations forwarded to the global heap.
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+  size_t allocation_count = 0;
+
+private:
+  void* do_allocate(size_t bytes, size_t alignment) override
+  {
+    ++allocation_count;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* ptr, size_t bytes, size_t alignment) override
+  {
+    std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+  }
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+template<class T>
+struct TaggedAllocator
+{
+  using value_type = T;
+
+  explicit TaggedAllocator(int tag)
+    : tag(tag)
+  {
+  }
+  template<class U>
+  TaggedAllocator(const TaggedAllocator<U>& other)
+    : tag(other.tag)
+  {
+  }
+
+  T* allocate(size_t count) { return std::allocator<T>().allocate(count); }
+  void deallocate(T* ptr, size_t count) { std::allocator<T>().deallocate(ptr, count); }
+
+  bool operator==(const TaggedAllocator& other) const { return tag == other.tag; }
+  bool operator!=(const TaggedAllocator& other) const { return tag != other.tag; }
+
+  int tag;
+};
+} // namespace
+
+TEST(AllocatorTest, pmr_output)
+{
+  CompactJsonWriter writer;
+  write_document(writer);
+
+  std::pmr::monotonic_buffer_resource arena;
+  PmrCompactJsonWriter pmr_writer(&arena);
+  write_document(pmr_writer);
+  EXPECT_EQ(std::string_view(pmr_writer.get_buffer()), writer.get_buffer());
+}
+
+TEST(AllocatorTest, arena_without_heap)
+{
+  // The arena has no upstream resource, so any allocation that does not come
+  // from its initial buffer fails.
+  char storage[16 * 1024];
+  std::pmr::monotonic_buffer_resource arena(storage, sizeof(storage), std::pmr::null_memory_resource());
+  PmrJsonWriter writer(&arena);
+  writer.set_pretty(true);
+  writer.set_use_colors(false);
+  write_document(writer);
+
+  JsonWriter heap_writer;
+  heap_writer.set_pretty(true);
+  heap_writer.set_use_colors(false);
+  write_document(heap_writer);
+  EXPECT_EQ(std::string_view(writer.get_buffer()), heap_writer.get_buffer());
+  EXPECT_GE(writer.get_buffer().data(), storage);
+  EXPECT_LT(writer.get_buffer().data(), storage + sizeof(storage));
+}
+
+TEST(AllocatorTest, arena_upstream)
+{
+  CountingResource upstream;
+  {
+    std::pmr::monotonic_buffer_resource arena(&upstream);
+    PmrCompactJsonWriter writer(&arena);
+    for (int i = 0; i < 10; ++i)
+      write_document(writer);
+    EXPECT_GT(upstream.allocation_count, 0u);
+  }
+
+  // The writer takes everything from the resource it was given.
+  const size_t allocation_count = upstream.allocation_count;
+  PmrCompactJsonWriter writer(&upstream);
+  write_document(writer);
+  EXPECT_GT(upstream.allocation_count, allocation_count);
+}
+
+TEST(AllocatorTest, buffer_keeps_allocator)
+{
+  std::pmr::monotonic_buffer_resource arena;
+  PmrCompactJsonWriter writer(&arena);
+  write_document(writer);
+
+  PmrCompactJsonWriter::String output = writer.take_buffer();
+  EXPECT_EQ(output.get_allocator().resource(), &arena);
+  EXPECT_EQ(writer.get_allocator().resource(), &arena);
+
+  writer.write_null();
+  writer.swap_buffer(output);
+  EXPECT_EQ(output, "null");
+  EXPECT_TRUE(writer.get_buffer().empty());
+  EXPECT_EQ(writer.get_allocator().resource(), &arena);
+}
+
+TEST(AllocatorTest, custom_allocator)
+{
+  using Writer = BasicJsonWriter<JsonMode::Off, JsonMode::Off, JsonEscape::Default, TaggedAllocator<char>>;
+  Writer writer(TaggedAllocator<char>(7));
+  write_document(writer);
+
+  CompactJsonWriter expected;
+  write_document(expected);
+  EXPECT_EQ(std::string_view(writer.get_buffer()), expected.get_buffer());
+  EXPECT_EQ(writer.take_buffer().get_allocator().tag, 7);
+  EXPECT_EQ(writer.get_allocator().tag, 7);
+}
+
+TEST(AllocatorTest, parallel_and_measure)
+{
+  std::vector<int> values(1000);
+  for (int i = 0; i < 1000; ++i)
+    values[i] = i;
+  const auto write_item = [](auto& writer, int value) { writer.write_integer(value); };
+
+  CompactJsonWriter expected;
+  expected.write_array(values.begin(), values.end(), write_item);
+
+  std::pmr::monotonic_buffer_resource arena;
+  PmrCompactJsonWriter writer(&arena);
+  const size_t size = writer.measure(
+    [&](PmrCompactJsonWriter& fragment) { fragment.write_array(values.begin(), values.end(), write_item); });
+  EXPECT_EQ(size, expected.get_buffer().size());
+  writer.write_array_parallel(values.begin(), values.end(), write_item, 4);
+  EXPECT_EQ(std::string_view(writer.get_buffer()), expected.get_buffer());
+}
@@ -0,0 +1,123 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "json_writer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+namespace {
+void
+write_records(JsonWriter& writer, int count)
+{
+  writer.begin_array();
+  for (int i = 0; i < count; ++i) {
+    writer.begin_array_item();
+    writer.begin_object();
+    writer.write_integer_field("id", i);
+    writer.write_string_field("message", "something happened");
+    writer.end_object();
+    writer.end_array_item();
+  }
+  writer.end_array();
+}
+
+std::string
+get_expected_output(int count)
+{
+  JsonWriter writer;
+  write_records(writer, count);
+  return writer.get_buffer();
+}
+
+std::string
+read_file(FILE* file)
+{
+  std::string content;
+  std::rewind(file);
+  char buffer[4096];
+  size_t size;
+  while ((size = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+    content.append(buffer, size);
+  return content;
+}
+} // namespace
+
+TEST(AsyncSinkTest, writes_everything)
+{
+  FILE* file = std::tmpfile();
+  ASSERT_NE(file, nullptr);
+
+  {
+    JsonAsyncFileSink sink(file, 3, 256);
+    JsonWriter writer;
+    writer.set_sink(&sink, 64);
+    write_records(writer, 1000);
+    writer.flush();
+    sink.flush();
+
+    const JsonAsyncFileSink::Stats stats = sink.get_stats();
+    EXPECT_EQ(stats.bytes_written, get_expected_output(1000).size());
+    EXPECT_GT(stats.buffers_written, 1u);
+    EXPECT_FALSE(sink.has_error());
+  }
+
+  EXPECT_EQ(read_file(file), get_expected_output(1000));
+  std::fclose(file);
+}
+
+TEST(AsyncSinkTest, close_flushes)
+{
+  FILE* file = std::tmpfile();
+  ASSERT_NE(file, nullptr);
+
+  JsonAsyncFileSink sink(file);
+  JsonWriter writer;
+  writer.set_sink(&sink);
+  write_records(writer, 10);
+  writer.flush();
+  sink.close();
+  sink.close();
+
+  EXPECT_EQ(read_file(file), get_expected_output(10));
+  std::fclose(file);
+}
+
+TEST(AsyncSinkTest, writes_larger_than_buffers)
+{
+  FILE* file = std::tmpfile();
+  ASSERT_NE(file, nullptr);
+
+  const std::string value(10000, 'x');
+  {
+    JsonAsyncFileSink sink(file, 2, 100);
+    JsonWriter writer;
+    writer.set_sink(&sink, 16);
+    writer.write_string(value);
+    writer.flush();
+  }
+
+  EXPECT_EQ(read_file(file), "\"" + value + "\"");
+  std::fclose(file);
+}
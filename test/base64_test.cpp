@@ -0,0 +1,187 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "json_writer.hpp"
+
+#include "colors.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+// Encodes bit by bit, as the specification reads.
+std::string
+encode_reference(const std::vector<unsigned char>& data, bool url)
+{
+  const char* alphabet = url ? "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"
+                             : "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string encoded;
+  unsigned group = 0;
+  int bit_count = 0;
+  for (unsigned char byte : data) {
+    for (int bit = 7; bit >= 0; --bit) {
+      group = (group << 1) | ((byte >> bit) & 1);
+      if (++bit_count == 6) {
+        encoded.push_back(alphabet[group]);
+        group = 0;
+        bit_count = 0;
+      }
+    }
+  }
+  if (bit_count != 0)
+    encoded.push_back(alphabet[group << (6 - bit_count)]);
+  while (!url && encoded.size() % 4 != 0)
+    encoded.push_back('=');
+  return encoded;
+}
+
+std::vector<unsigned char>
+make_data(size_t size)
+{
+  std::vector<unsigned char> data(size);
+  uint32_t state = 12345;
+  for (unsigned char& byte : data) {
+    state = state * 1103515245 + 12345;
+    byte = static_cast<unsigned char>(state >> 16);
+  }
+  return data;
+}
+
+std::string
+write_base64(const std::vector<unsigned char>& data, JsonBase64 alphabet = JsonBase64::Standard)
+{
+  CompactJsonWriter writer;
+  writer.write_base64(data, alphabet);
+  return std::string(writer.get_buffer());
+}
+} // namespace
+
+TEST(Base64Test, rfc4648_vectors)
+{
+  const std::string_view inputs[] = { "", "f", "fo", "foo", "foob", "fooba", "foobar" };
+  const char* const expected[] = { "\"\"",         "\"Zg==\"",     "\"Zm8=\"",    "\"Zm9v\"",
+                                   "\"Zm9vYg==\"", "\"Zm9vYmE=\"", "\"Zm9vYmFy\"" };
+  for (size_t i = 0; i < std::size(inputs); ++i) {
+    CompactJsonWriter writer;
+    writer.write_base64(inputs[i]);
+    EXPECT_EQ(writer.get_buffer(), expected[i]);
+  }
+}
+
+TEST(Base64Test, url_alphabet)
+{
+  const std::vector<unsigned char> data = { 0xFB, 0xFF, 0xBF, 0x66 };
+  EXPECT_EQ(write_base64(data), "\"+/+/Zg==\"");
+  EXPECT_EQ(write_base64(data, JsonBase64::Url), "\"-_-_Zg\"");
+}
+
+TEST(Base64Test, matches_reference)
+{
+  // Covers the vectorized loops and every size of their remainders.
+  for (size_t size = 0; size <= 300; ++size) {
+    const std::vector<unsigned char> data = make_data(size);
+    EXPECT_EQ(write_base64(data), "\"" + encode_reference(data, false) + "\"") << size;
+    EXPECT_EQ(write_base64(data, JsonBase64::Url), "\"" + encode_reference(data, true) + "\"") << size;
+  }
+}
+
+TEST(Base64Test, every_byte_value)
+{
+  std::vector<unsigned char> data;
+  for (int shift = 0; shift < 3; ++shift) {
+    for (int i = 0; i < 256; ++i)
+      data.push_back(static_cast<unsigned char>(i + shift));
+  }
+  EXPECT_EQ(write_base64(data), "\"" + encode_reference(data, false) + "\"");
+  EXPECT_EQ(write_base64(data, JsonBase64::Url), "\"" + encode_reference(data, true) + "\"");
+}
+
+TEST(Base64Test, large)
+{
+  const std::vector<unsigned char> data = make_data(100000 + 1);
+  EXPECT_EQ(write_base64(data), "\"" + encode_reference(data, false) + "\"");
+}
+
+TEST(Base64Test, containers)
+{
+  const std::vector<std::byte> bytes = { std::byte{ 'f' }, std::byte{ 'o' }, std::byte{ 'o' } };
+  const std::array<uint8_t, 2> array = { 'f', 'o' };
+  const unsigned char raw[] = { 'f' };
+
+  CompactJsonWriter writer;
+  writer.begin_array();
+  writer.begin_array_item();
+  writer.write_base64(bytes);
+  writer.end_array_item();
+  writer.begin_array_item();
+  writer.write_base64(array);
+  writer.end_array_item();
+  writer.begin_array_item();
+  writer.write_base64(raw, sizeof(raw));
+  writer.end_array_item();
+  writer.begin_array_item();
+  writer.write_base64(std::string("foob"));
+  writer.end_array_item();
+  writer.end_array();
+  EXPECT_EQ(writer.get_buffer(), "[\"Zm9v\",\"Zm8=\",\"Zg==\",\"Zm9vYg==\"]");
+}
+
+TEST(Base64Test, write_base64_field)
+{
+  static const JsonKey KEY("sha");
+  const std::vector<unsigned char> data = { 0xFB, 0xFF };
+
+  JsonWriter writer;
+  writer.set_use_colors(false);
+  writer.set_pretty(true);
+  writer.begin_object();
+  writer.write_base64_field("data", data.data(), data.size());
+  writer.write_base64_field(KEY, data, JsonBase64::Url);
+  writer.end_object();
+  EXPECT_EQ(writer.get_buffer(), "{\n  \"data\": \"+/8=\",\n  \"sha\": \"-_8\"\n}");
+}
+
+TEST(Base64Test, colored)
+{
+  JsonWriter writer;
+  writer.set_use_colors(true);
+  writer.write_base64(std::string_view("foo"));
+  EXPECT_EQ(writer.get_buffer(), COLOR_STRING "\"Zm9v\"" COLOR_RESET);
+}
+
+TEST(Base64Test, token_stream)
+{
+  const std::vector<unsigned char> data = make_data(100);
+
+  JsonTokenStream tokens;
+  tokens.begin_object();
+  tokens.write_base64_field("data", data);
+  tokens.end_object();
+  CompactJsonWriter writer;
+  tokens.replay(writer);
+  EXPECT_EQ(writer.get_buffer(), "{\"data\":\"" + encode_reference(data, false) + "\"}");
+}
@@ -0,0 +1,225 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "json_writer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace {
+template<JsonEscape Escape>
+std::string
+write_string(std::string_view value)
+{
+  BasicJsonWriter<JsonMode::Off, JsonMode::Off, Escape> writer;
+  writer.write_string(value);
+  return writer.get_buffer();
+}
+
+// Pads value on both sides so that the vectorized search is used.
+std::string
+pad(std::string_view value)
+{
+  return std::string(40, 'a') + std::string(value) + std::string(40, 'b');
+}
+
+const std::string PADDING_A(40, 'a');
+const std::string PADDING_B(40, 'b');
+} // namespace
+
+TEST(EscapePolicyTest, default_policy)
+{
+  EXPECT_EQ(write_string<JsonEscape::Default>("\b\x01<\xff"), "\"\b\x01<\xff\"");
+}
+
+TEST(EscapePolicyTest, controls)
+{
+  constexpr JsonEscape ESCAPE = JsonEscape::Controls;
+  EXPECT_EQ(write_string<ESCAPE>("\b\f\n\r\t\x01\x1f\x7f"), "\"\\b\\f\\n\\r\\t\\u0001\\u001f\x7f\"");
+  EXPECT_EQ(write_string<ESCAPE>(pad("\x01")), "\"" + PADDING_A + "\\u0001" + PADDING_B + "\"");
+}
+
+TEST(EscapePolicyTest, html)
+{
+  constexpr JsonEscape ESCAPE = JsonEscape::Html;
+  EXPECT_EQ(write_string<ESCAPE>("</script>&"), "\"\\u003c/script\\u003e\\u0026\"");
+  EXPECT_EQ(write_string<ESCAPE>(pad("<")), "\"" + PADDING_A + "\\u003c" + PADDING_B + "\"");
+}
+
+TEST(EscapePolicyTest, replace_invalid_utf8)
+{
+  constexpr JsonEscape ESCAPE = JsonEscape::ReplaceInvalidUtf8;
+  // Valid sequences of every size are kept.
+  EXPECT_EQ(write_string<ESCAPE>("\xc3\xa9\xe6\x97\xa5\xf0\x9f\x98\x80"), "\"\xc3\xa9\xe6\x97\xa5\xf0\x9f\x98\x80\"");
+  // Lone continuation byte, invalid lead, overlong, surrogate, out of range and
+  // truncated sequences.
+  EXPECT_EQ(write_string<ESCAPE>("\x80"), "\"\xef\xbf\xbd\"");
+  EXPECT_EQ(write_string<ESCAPE>("\xff"), "\"\xef\xbf\xbd\"");
+  EXPECT_EQ(write_string<ESCAPE>("\xc0\xaf"), "\"\xef\xbf\xbd\xef\xbf\xbd\"");
+  EXPECT_EQ(write_string<ESCAPE>("\xed\xa0\x80"), "\"\xef\xbf\xbd\xef\xbf\xbd\xef\xbf\xbd\"");
+  EXPECT_EQ(write_string<ESCAPE>("\xf4\x90\x80\x80"), "\"\xef\xbf\xbd\xef\xbf\xbd\xef\xbf\xbd\xef\xbf\xbd\"");
+  EXPECT_EQ(write_string<ESCAPE>("a\xe6\x97"), "\"a\xef\xbf\xbd\xef\xbf\xbd\"");
+  EXPECT_EQ(write_string<ESCAPE>(pad("\xc3\xa9\xc3")), "\"" + PADDING_A + "\xc3\xa9\xef\xbf\xbd" + PADDING_B + "\"");
+}
+
+TEST(EscapePolicyTest, reject_invalid_utf8)
+{
+  BasicJsonWriter<JsonMode::Off, JsonMode::Off, JsonEscape::RejectInvalidUtf8> writer;
+  writer.write_string("\xc3\xa9");
+  EXPECT_FALSE(writer.has_invalid_utf8());
+  writer.write_string("a\xff"
+                      "b");
+  EXPECT_TRUE(writer.has_invalid_utf8());
+  EXPECT_EQ(writer.get_buffer(), "\"\xc3\xa9\"\"ab\"");
+
+  writer.reset();
+  EXPECT_FALSE(writer.has_invalid_utf8());
+}
+
+TEST(EscapePolicyTest, ascii)
+{
+  constexpr JsonEscape ESCAPE = JsonEscape::Ascii;
+  EXPECT_EQ(write_string<ESCAPE>("h\xc3\xa9llo \xe6\x97\xa5 \xf0\x9f\x98\x80"),
+            "\"h\\u00e9llo \\u65e5 \\ud83d\\ude00\"");
+  EXPECT_EQ(write_string<ESCAPE>("\xff"), "\"\\ufffd\"");
+  EXPECT_EQ(write_string<ESCAPE>(pad("\xf0\x9f\x98\x80")), "\"" + PADDING_A + "\\ud83d\\ude00" + PADDING_B + "\"");
+}
+
+TEST(EscapePolicyTest, combined)
+{
+  constexpr JsonEscape ESCAPE = JsonEscape::Ascii | JsonEscape::Html | JsonEscape::Controls;
+  EXPECT_EQ(write_string<ESCAPE>("<\xc3\xa9>\x01\"\n"), "\"\\u003c\\u00e9\\u003e\\u0001\\\"\\n\"");
+}
+
+TEST(EscapePolicyTest, dense_non_ascii)
+{
+  // Crosses the escaping blocks in the middle of sequences.
+  std::string value;
+  std::string expected = "\"";
+  for (int i = 0; i < 50; ++i) {
+    value += "\xe6\x97\xa5";
+    expected += "\\u65e5";
+  }
+  expected += "\"";
+  EXPECT_EQ(write_string<JsonEscape::Ascii>(value), expected);
+
+  std::string replaced = write_string<JsonEscape::ReplaceInvalidUtf8>(value);
+  EXPECT_EQ(replaced, "\"" + value + "\"");
+}
+
+TEST(EscapePolicyTest, field_names)
+{
+  BasicJsonWriter<JsonMode::Off, JsonMode::Off, JsonEscape::Html> writer;
+  writer.begin_object();
+  writer.write_string_field("<key>", "&");
+  writer.end_object();
+  EXPECT_EQ(writer.get_buffer(), "{\"\\u003ckey\\u003e\":\"\\u0026\"}");
+}
+
+namespace {
+// Straightforward reference of the ReplaceInvalidUtf8 policy, decoding each
+// sequence and checking its code point.
+std::string
+replace_invalid_utf8_reference(const std::string& value)
+{
+  std::string output = "\"";
+  size_t i = 0;
+  while (i < value.size()) {
+    const unsigned char lead = value[i];
+    if (lead < 0x80) {
+      switch (lead) {
+        case '"':
+          output += "\\\"";
+          break;
+        case '\\':
+          output += "\\\\";
+          break;
+        case '\n':
+          output += "\\n";
+          break;
+        case '\r':
+          output += "\\r";
+          break;
+        case '\t':
+          output += "\\t";
+          break;
+        case '\f':
+          output += "\\f";
+          break;
+        default:
+          output += static_cast<char>(lead);
+      }
+      ++i;
+      continue;
+    }
+
+    size_t size = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 0;
+    uint32_t code_point = lead & (0x7F >> size);
+    bool is_valid = size != 0 && lead <= 0xF7 && i + size <= value.size();
+    for (size_t j = 1; is_valid && j < size; ++j) {
+      const unsigned char byte = value[i + j];
+      is_valid = (byte & 0xC0) == 0x80;
+      code_point = (code_point << 6) | (byte & 0x3F);
+    }
+    const uint32_t min_code_point = size == 2 ? 0x80 : size == 3 ? 0x800 : 0x10000;
+    is_valid = is_valid && code_point >= min_code_point && code_point <= 0x10FFFF &&
+               (code_point < 0xD800 || code_point > 0xDFFF);
+
+    if (is_valid) {
+      output.append(value, i, size);
+      i += size;
+    } else {
+      output += "\xef\xbf\xbd";
+      ++i;
+    }
+  }
+  return output + "\"";
+}
+} // namespace
+
+TEST(EscapePolicyTest, random_utf8)
+{
+  // Mostly valid text with random corruptions, to exercise the vectorized
+  // validation around chunk boundaries.
+  const char* const PIECES[] = { "a", "bc", " ", "\xc3\xa9", "\xe6\x97\xa5", "\xf0\x9f\x98\x80", "\"", "\n" };
+  uint64_t state = 0x9E3779B97F4A7C15ULL;
+  const auto next = [&state] {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  };
+
+  for (int iteration = 0; iteration < 2000; ++iteration) {
+    std::string value;
+    const size_t piece_count = next() % 64;
+    for (size_t i = 0; i < piece_count; ++i)
+      value += PIECES[next() % (sizeof(PIECES) / sizeof(PIECES[0]))];
+    const size_t corruption_count = next() % 3;
+    for (size_t i = 0; i < corruption_count && !value.empty(); ++i)
+      value[next() % value.size()] = static_cast<char>(next());
+
+    ASSERT_EQ(write_string<JsonEscape::ReplaceInvalidUtf8>(value), replace_invalid_utf8_reference(value))
+      << "iteration " << iteration;
+  }
+}
@@ -0,0 +1,212 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "json_writer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+void
+write_user(CompactJsonWriter& writer, uint64_t id, uint64_t version)
+{
+  writer.begin_object();
+  writer.write_integer_field("id", id);
+  writer.write_integer_field("version", version);
+  writer.end_object();
+}
+
+std::string
+render_user(uint64_t id, uint64_t version)
+{
+  CompactJsonWriter writer;
+  write_user(writer, id, version);
+  return std::string(writer.get_buffer());
+}
+} // namespace
+
+TEST(FragmentCacheTest, renders_once)
+{
+  JsonFragmentCache cache;
+  int render_count = 0;
+  const auto render = [&](CompactJsonWriter& writer) {
+    ++render_count;
+    write_user(writer, 7, 1);
+  };
+
+  EXPECT_EQ(*cache.get(7, 1, render), render_user(7, 1));
+  EXPECT_EQ(*cache.get(7, 1, render), render_user(7, 1));
+  EXPECT_EQ(render_count, 1);
+
+  const JsonFragmentCache::Stats stats = cache.get_stats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(cache.get_size(), render_user(7, 1).size());
+}
+
+TEST(FragmentCacheTest, versions)
+{
+  JsonFragmentCache cache;
+  cache.insert(1, 2, render_user(1, 2));
+  EXPECT_EQ(cache.find(1, 1), nullptr);
+  ASSERT_NE(cache.find(1, 2), nullptr);
+
+  // An older version does not replace a newer one, but a newer one does.
+  EXPECT_EQ(*cache.insert(1, 1, render_user(1, 1)), render_user(1, 1));
+  EXPECT_EQ(cache.find(1, 1), nullptr);
+  ASSERT_NE(cache.find(1, 2), nullptr);
+  cache.insert(1, 3, render_user(1, 3));
+  EXPECT_EQ(cache.find(1, 2), nullptr);
+  ASSERT_NE(cache.find(1, 3), nullptr);
+  EXPECT_EQ(*cache.find(1, 3), render_user(1, 3));
+  EXPECT_EQ(cache.get_size(), render_user(1, 3).size());
+}
+
+TEST(FragmentCacheTest, erase_and_clear)
+{
+  JsonFragmentCache cache;
+  for (uint64_t id = 0; id < 100; ++id)
+    cache.insert(id, 1, render_user(id, 1));
+
+  cache.erase(42);
+  EXPECT_EQ(cache.find(42, 1), nullptr);
+  EXPECT_NE(cache.find(43, 1), nullptr);
+  cache.clear();
+  EXPECT_EQ(cache.find(43, 1), nullptr);
+  EXPECT_EQ(cache.get_size(), 0u);
+}
+
+TEST(FragmentCacheTest, eviction)
+{
+  // Room for about 4 fragments per shard.
+  const size_t fragment_size = render_user(1000, 1).size();
+  JsonFragmentCache cache(4 * fragment_size * JsonFragmentCache::SHARD_COUNT);
+
+  // Kept referenced, the first fragment survives the others.
+  cache.insert(1000, 1, render_user(1000, 1));
+  for (uint64_t id = 1001; id < 2000; ++id) {
+    ASSERT_NE(cache.find(1000, 1), nullptr) << id;
+    cache.insert(id, 1, render_user(id, 1));
+  }
+
+  EXPECT_GT(cache.get_stats().evictions, 0u);
+  EXPECT_LE(cache.get_size(), 4 * fragment_size * JsonFragmentCache::SHARD_COUNT);
+
+  // Too large for a shard, and the cached version is dropped.
+  const std::string large = '"' + std::string(8 * fragment_size, 'x') + '"';
+  EXPECT_EQ(*cache.insert(1000, 2, large), large);
+  EXPECT_EQ(cache.find(1000, 1), nullptr);
+  EXPECT_EQ(cache.find(1000, 2), nullptr);
+}
+
+TEST(FragmentCacheTest, write_pretty)
+{
+  JsonFragmentCache cache;
+  JsonWriter writer;
+  writer.set_use_colors(false);
+  writer.set_pretty(true);
+  writer.begin_object();
+  writer.begin_field("user");
+  cache.write(writer, 5, 1, [](CompactJsonWriter& fragment_writer) { write_user(fragment_writer, 5, 1); });
+  writer.end_field();
+  writer.end_object();
+  EXPECT_EQ(writer.get_buffer(), "{\n  \"user\": {\n    \"id\": 5,\n    \"version\": 1\n  }\n}");
+}
+
+TEST(FragmentCacheTest, insert_compacts)
+{
+  JsonFragmentCache cache;
+  EXPECT_EQ(*cache.insert(1, 1, "{ \"a b\" : [1, 2] }"), R"({"a b":[1,2]})");
+  EXPECT_EQ(*cache.find(1, 1), R"({"a b":[1,2]})");
+}
+
+TEST(FragmentCacheTest, escape_policy)
+{
+  using HtmlWriter = BasicJsonWriter<JsonMode::Off, JsonMode::Off, JsonEscape::Html>;
+  const auto render = [](auto& fragment_writer) { fragment_writer.write_string("<script>"); };
+
+  JsonFragmentCache cache;
+  HtmlWriter html_writer;
+  cache.write(html_writer, 1, 1, render);
+  EXPECT_EQ(html_writer.get_buffer(), R"("\u003cscript\u003e")");
+  EXPECT_EQ(cache.find(1, 1), nullptr);
+  EXPECT_NE(cache.find(1, 1, JsonEscape::Html), nullptr);
+
+  // A fragment cached for another policy is rendered again.
+  CompactJsonWriter writer;
+  cache.write(writer, 1, 1, render);
+  EXPECT_EQ(writer.get_buffer(), R"("<script>")");
+  html_writer.reset();
+  cache.write(html_writer, 1, 1, render);
+  EXPECT_EQ(html_writer.get_buffer(), R"("\u003cscript\u003e")");
+}
+
+TEST(FragmentCacheTest, nested_fragments)
+{
+  JsonFragmentCache cache;
+  const auto render_team = [&](CompactJsonWriter& writer) {
+    writer.begin_array();
+    for (uint64_t id = 1; id <= 2; ++id) {
+      writer.begin_array_item();
+      cache.write(writer, id, 1, [id](CompactJsonWriter& user_writer) { write_user(user_writer, id, 1); });
+      writer.end_array_item();
+    }
+    writer.end_array();
+  };
+
+  EXPECT_EQ(*cache.get(100, 1, render_team), "[" + render_user(1, 1) + "," + render_user(2, 1) + "]");
+  EXPECT_NE(cache.find(1, 1), nullptr);
+}
+
+TEST(FragmentCacheTest, concurrent)
+{
+  constexpr int THREAD_COUNT = 4;
+  constexpr uint64_t ID_COUNT = 64;
+  JsonFragmentCache cache(64 * 1024);
+  std::atomic<int> failures{ 0 };
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < THREAD_COUNT; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < 2000; ++i) {
+        const uint64_t id = (i * 7 + t) % ID_COUNT;
+        const uint64_t version = i / 500;
+        const JsonFragmentCache::Fragment fragment =
+          cache.get(id, version, [&](CompactJsonWriter& writer) { write_user(writer, id, version); });
+        if (*fragment != render_user(id, version))
+          ++failures;
+        if (i % 100 == 0)
+          cache.erase(id);
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  EXPECT_EQ(failures, 0);
+  const JsonFragmentCache::Stats stats = cache.get_stats();
+  EXPECT_EQ(stats.hits + stats.misses, uint64_t(THREAD_COUNT) * 2000);
+}
@@ -0,0 +1,136 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "json_writer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+const std::string BLOB(1000, 'x');
+const std::string ESCAPED_BLOB = std::string(500, 'y') + "\n" + std::string(500, 'y');
+
+void
+write_document(JsonWriter& writer)
+{
+  writer.begin_object();
+  writer.begin_field("blob");
+  writer.write_string_ref(BLOB);
+  writer.end_field();
+  writer.begin_field("escaped");
+  writer.write_string_ref(ESCAPED_BLOB);
+  writer.end_field();
+  writer.begin_field("small");
+  writer.write_string_ref("small");
+  writer.end_field();
+  writer.begin_field("again");
+  writer.write_string_ref(BLOB);
+  writer.end_field();
+  writer.end_object();
+}
+
+std::string
+concatenate(const std::vector<std::string_view>& segments)
+{
+  std::string output;
+  for (std::string_view segment : segments)
+    output.append(segment);
+  return output;
+}
+} // namespace
+
+TEST(GatherTest, same_output_as_copying)
+{
+  for (bool pretty : { false, true }) {
+    for (bool use_colors : { false, true }) {
+      JsonWriter expected;
+      expected.set_pretty(pretty);
+      expected.set_use_colors(use_colors);
+      write_document(expected);
+
+      JsonWriter writer;
+      writer.set_pretty(pretty);
+      writer.set_use_colors(use_colors);
+      writer.set_gather_mode(true);
+      write_document(writer);
+
+      EXPECT_EQ(concatenate(writer.get_segments()), expected.get_buffer());
+      EXPECT_EQ(writer.get_output_size(), expected.get_buffer().size());
+    }
+  }
+}
+
+TEST(GatherTest, large_clean_strings_are_referenced)
+{
+  JsonWriter writer;
+  writer.set_gather_mode(true);
+  write_document(writer);
+
+  const std::vector<std::string_view> segments = writer.get_segments();
+  ASSERT_EQ(segments.size(), 5u);
+  EXPECT_EQ(segments[1].data(), BLOB.data());
+  EXPECT_EQ(segments[3].data(), BLOB.data());
+  // The escaped and small strings are copied.
+  EXPECT_LT(writer.get_buffer().size(), 2 * BLOB.size());
+  EXPECT_NE(writer.get_buffer().find("\\n"), std::string::npos);
+}
+
+TEST(GatherTest, disabled_by_default)
+{
+  JsonWriter writer;
+  write_document(writer);
+  EXPECT_EQ(writer.get_segments().size(), 1u);
+  EXPECT_EQ(writer.get_output_size(), writer.get_buffer().size());
+}
+
+TEST(GatherTest, reset_drops_references)
+{
+  JsonWriter writer;
+  writer.set_gather_mode(true);
+  write_document(writer);
+  writer.reset();
+  writer.write_null();
+  EXPECT_EQ(writer.get_segments().size(), 1u);
+  EXPECT_EQ(concatenate(writer.get_segments()), "null");
+}
+
+#ifdef JSON_WRITER_HAS_POSIX
+TEST(GatherTest, write_segments)
+{
+  FILE* file = std::tmpfile();
+  ASSERT_NE(file, nullptr);
+
+  JsonWriter writer;
+  writer.set_gather_mode(true);
+  write_document(writer);
+  ASSERT_TRUE(writer.write_segments(fileno(file)));
+
+  std::string content(writer.get_output_size() + 1, '\0');
+  std::rewind(file);
+  content.resize(std::fread(&content[0], 1, content.size(), file));
+  EXPECT_EQ(content, concatenate(writer.get_segments()));
+  std::fclose(file);
+}
+#endif
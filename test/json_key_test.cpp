@@ -0,0 +1,111 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "json_writer.hpp"
+
+#include "colors.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(JsonKeyTest, quoted)
+{
+  EXPECT_EQ(JsonKey("name").get_quoted(), "\"name\":");
+  EXPECT_EQ(JsonKey("").get_quoted(), "\"\":");
+  EXPECT_EQ(JsonKey("\"\\\n").get_quoted(), "\"\\\"\\\\\\n\":");
+}
+
+TEST(JsonKeyTest, same_output_as_string_name)
+{
+  const JsonKey key("foo\tbar");
+  for (bool pretty : { false, true }) {
+    for (bool use_colors : { false, true }) {
+      JsonWriter expected;
+      expected.set_pretty(pretty);
+      expected.set_use_colors(use_colors);
+      expected.begin_object();
+      expected.write_integer_field("foo\tbar", 42);
+      expected.write_null_field("foo\tbar");
+      expected.end_object();
+
+      JsonWriter writer;
+      writer.set_pretty(pretty);
+      writer.set_use_colors(use_colors);
+      writer.begin_object();
+      writer.write_integer_field(key, 42);
+      writer.write_null_field(key);
+      writer.end_object();
+
+      EXPECT_EQ(writer.get_buffer(), expected.get_buffer());
+    }
+  }
+}
+
+TEST(JsonKeyTest, escape_policy)
+{
+  BasicJsonWriter<JsonMode::Off, JsonMode::Off, JsonEscape::Html> html_writer;
+  html_writer.begin_object();
+  html_writer.write_null_field(JsonKey("<b>"));
+  html_writer.write_null_field(JsonKey("b"));
+  html_writer.end_object();
+  EXPECT_EQ(html_writer.get_buffer(), R"({"\u003cb\u003e":null,"b":null})");
+
+  BasicJsonWriter<JsonMode::Off, JsonMode::Off, JsonEscape::Ascii> ascii_writer;
+  ascii_writer.write_null_field(JsonKey("\xc3\xa9"));
+  EXPECT_EQ(ascii_writer.get_buffer(), R"("\u00e9":null)");
+
+  // Only the writers with another policy escape the name again.
+  const JsonKey key("\xc3\xa9<");
+  EXPECT_TRUE(key.depends_on_escape_policy());
+  EXPECT_FALSE(JsonKey("a\"b").depends_on_escape_policy());
+  CompactJsonWriter writer;
+  writer.write_null_field(key);
+  EXPECT_EQ(writer.get_buffer(), "\"\xc3\xa9<\":null");
+}
+
+TEST(JsonKeyTest, colored_field)
+{
+  const JsonKey key("foo");
+  JsonWriter writer;
+  writer.set_use_colors(true);
+  writer.set_pretty(false);
+  writer.write_bool_field(key, true);
+  EXPECT_EQ(writer.get_buffer(), COLOR_FIELD "\"foo\":" COLOR_RESET COLOR_BOOLEAN "true" COLOR_RESET);
+}
+
+TEST(JsonKeyTest, all_field_functions)
+{
+  const JsonKey key("k");
+  CompactJsonWriter writer;
+  writer.begin_object();
+  writer.write_null_field(key);
+  writer.write_bool_field(key, false);
+  writer.write_string_field(key, "v");
+  writer.write_integer_field(key, -1);
+  writer.write_float_field(key, 0.5);
+  writer.write_float_field(key, 0.5, 2);
+  writer.begin_field(key);
+  writer.begin_array();
+  writer.end_array();
+  writer.end_field();
+  writer.end_object();
+  EXPECT_EQ(writer.get_buffer(), "{\"k\":null,\"k\":false,\"k\":\"v\",\"k\":-1,\"k\":0.5,\"k\":0.50,\"k\":[]}");
+}
@@ -0,0 +1,105 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "json_writer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(LogStreamTest, single_producer)
+{
+  std::string output;
+  JsonStringSink sink(output);
+  {
+    JsonLogStream stream(sink);
+    for (int i = 0; i < 3; ++i) {
+      stream.write([i](CompactJsonWriter& writer) {
+        writer.begin_object();
+        writer.write_integer_field("id", i);
+        writer.end_object();
+      });
+    }
+  }
+
+  EXPECT_EQ(output, "{\"id\":0}\n{\"id\":1}\n{\"id\":2}\n");
+}
+
+TEST(LogStreamTest, preserves_per_thread_order)
+{
+  constexpr int THREAD_COUNT = 8;
+  constexpr int RECORD_COUNT = 2000;
+
+  std::string output;
+  JsonStringSink sink(output);
+  JsonLogStream stream(sink, 16);
+
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < THREAD_COUNT; ++thread) {
+    threads.emplace_back([&stream, thread] {
+      for (int i = 0; i < RECORD_COUNT; ++i) {
+        stream.write([thread, i](CompactJsonWriter& writer) {
+          writer.begin_object();
+          writer.write_integer_field("thread", thread);
+          writer.write_integer_field("seq", i);
+          writer.end_object();
+        });
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+  stream.close();
+
+  EXPECT_EQ(stream.get_stats().records_written, static_cast<uint64_t>(THREAD_COUNT * RECORD_COUNT));
+
+  std::vector<int> next_seq(THREAD_COUNT, 0);
+  std::istringstream lines(output);
+  std::string line;
+  int line_count = 0;
+  while (std::getline(lines, line)) {
+    int thread;
+    int seq;
+    ASSERT_EQ(std::sscanf(line.c_str(), "{\"thread\":%d,\"seq\":%d}", &thread, &seq), 2) << line;
+    ASSERT_GE(thread, 0);
+    ASSERT_LT(thread, THREAD_COUNT);
+    EXPECT_EQ(seq, next_seq[thread]);
+    next_seq[thread] = seq + 1;
+    ++line_count;
+  }
+  EXPECT_EQ(line_count, THREAD_COUNT * RECORD_COUNT);
+}
+
+TEST(LogStreamTest, close_is_idempotent)
+{
+  std::string output;
+  JsonStringSink sink(output);
+  JsonLogStream stream(sink);
+  stream.write([](CompactJsonWriter& writer) { writer.write_null(); });
+  stream.close();
+  stream.close();
+  EXPECT_EQ(output, "null\n");
+}
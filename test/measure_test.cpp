@@ -0,0 +1,95 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "json_writer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace {
+void
+write_document(JsonWriter& writer)
+{
+  writer.begin_object();
+  writer.write_string_field("name", "Bob \"the\" builder\n");
+  writer.write_integer_field("age", 42);
+  writer.write_float_field("height", 175.6);
+  writer.begin_field("children");
+  writer.begin_array();
+  for (int i = 0; i < 1000; ++i) {
+    writer.begin_array_item();
+    writer.begin_object();
+    writer.write_integer_field("id", i);
+    writer.write_bool_field("is_adult", i % 2 == 0);
+    writer.end_object();
+    writer.end_array_item();
+  }
+  writer.end_array();
+  writer.end_field();
+  writer.write_null_field("extra");
+  writer.end_object();
+}
+} // namespace
+
+TEST(MeasureTest, matches_output_size)
+{
+  for (bool pretty : { false, true }) {
+    for (bool colors : { false, true }) {
+      JsonWriter writer;
+      writer.set_pretty(pretty);
+      writer.set_use_colors(colors);
+      const size_t size = writer.measure(write_document);
+      write_document(writer);
+      EXPECT_EQ(size, writer.get_buffer().size());
+    }
+  }
+}
+
+TEST(MeasureTest, at_current_position)
+{
+  JsonWriter writer;
+  writer.begin_array();
+  writer.begin_array_item();
+  writer.write_integer(1);
+  writer.end_array_item();
+
+  const auto write_item = [](JsonWriter& writer) {
+    writer.begin_array_item();
+    writer.begin_object();
+    writer.write_string_field("key", "value");
+    writer.end_object();
+    writer.end_array_item();
+  };
+  const size_t old_size = writer.get_buffer().size();
+  const size_t size = writer.measure(write_item);
+  write_item(writer);
+  EXPECT_EQ(size, writer.get_buffer().size() - old_size);
+}
+
+TEST(MeasureTest, does_not_change_writer)
+{
+  JsonWriter writer;
+  writer.begin_array();
+  EXPECT_GT(writer.measure(write_document), 0u);
+  EXPECT_EQ(writer.get_buffer(), "[");
+}
@@ -0,0 +1,203 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "json_writer.hpp"
+
+#include <gtest/gtest.h>
+
+#ifdef JSON_WRITER_HAS_POSIX
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+class MmapFileTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    char path[] = "/tmp/json_writer_mmap_XXXXXX";
+    m_fd = mkstemp(path);
+    ASSERT_GE(m_fd, 0);
+    m_read_only_fd = open(path, O_RDONLY);
+    ASSERT_GE(m_read_only_fd, 0);
+    unlink(path);
+  }
+
+  void TearDown() override
+  {
+    close(m_fd);
+    close(m_read_only_fd);
+  }
+
+  std::string read_file() const
+  {
+    std::string content;
+    char buffer[4096];
+    ssize_t size;
+    off_t offset = 0;
+    while ((size = pread(m_fd, buffer, sizeof(buffer), offset)) > 0) {
+      content.append(buffer, size);
+      offset += size;
+    }
+    return content;
+  }
+
+  off_t get_file_size() const
+  {
+    struct stat st;
+    fstat(m_fd, &st);
+    return st.st_size;
+  }
+
+  int m_fd = -1;
+  int m_read_only_fd = -1;
+};
+
+template<class Writer>
+void
+write_integers(Writer& writer)
+{
+  writer.begin_array();
+  for (int i = 0; i < 2000; ++i) {
+    writer.begin_array_item();
+    writer.write_integer(i);
+    writer.end_array_item();
+  }
+  writer.end_array();
+}
+} // namespace
+
+TEST_F(MmapFileTest, writes_and_truncates)
+{
+  // Small chunks so that the mapping is grown several times.
+  MmapJsonWriter writer(JsonMmapFile(m_fd, 4096));
+  write_integers(writer);
+  EXPECT_GT(writer.get_buffer().capacity(), 8192u);
+
+  JsonWriter reference;
+  write_integers(reference);
+  EXPECT_EQ(writer.get_buffer().view(), reference.get_buffer());
+
+  JsonMmapFileBuffer buffer = writer.take_buffer();
+  EXPECT_TRUE(buffer.close());
+  EXPECT_FALSE(buffer.has_error());
+  EXPECT_EQ(read_file(), reference.get_buffer());
+  EXPECT_EQ(get_file_size(), static_cast<off_t>(reference.get_buffer().size()));
+}
+
+TEST_F(MmapFileTest, destructor_closes)
+{
+  {
+    MmapCompactJsonWriter writer(JsonMmapFile{ m_fd });
+    writer.write_string("abc");
+  }
+  EXPECT_EQ(read_file(), "\"abc\"");
+}
+
+TEST_F(MmapFileTest, replaces_content)
+{
+  ASSERT_EQ(write(m_fd, "previous content", 16), 16);
+
+  MmapCompactJsonWriter writer(JsonMmapFile{ m_fd });
+  writer.write_null();
+  EXPECT_TRUE(writer.take_buffer().close());
+  EXPECT_EQ(read_file(), "null");
+}
+
+TEST_F(MmapFileTest, empty_output)
+{
+  ASSERT_EQ(write(m_fd, "previous content", 16), 16);
+
+  JsonMmapFileBuffer buffer(JsonMmapFile{ m_fd });
+  EXPECT_TRUE(buffer.close());
+  EXPECT_EQ(get_file_size(), 0);
+}
+
+TEST_F(MmapFileTest, value_larger_than_chunk)
+{
+  const std::string value(10000, 'x');
+  MmapCompactJsonWriter writer(JsonMmapFile(m_fd, 4096));
+  writer.write_string(value);
+  EXPECT_TRUE(writer.take_buffer().close());
+  EXPECT_EQ(read_file(), '"' + value + '"');
+}
+
+TEST_F(MmapFileTest, take_buffer_outlives_writer)
+{
+  {
+    MmapCompactJsonWriter writer(JsonMmapFile{ m_fd });
+    writer.write_string("hello");
+    EXPECT_TRUE(writer.take_buffer().close());
+    // Not written to the file anymore.
+    writer.write_null();
+  }
+  EXPECT_EQ(read_file(), "\"hello\"");
+
+  {
+    MmapCompactJsonWriter writer(JsonMmapFile{ m_fd });
+    writer.write_integer(42);
+    JsonMmapFileBuffer buffer = writer.take_buffer();
+  }
+  EXPECT_EQ(read_file(), "42");
+}
+
+TEST_F(MmapFileTest, reset_starts_over)
+{
+  MmapCompactJsonWriter writer(JsonMmapFile{ m_fd });
+  writer.write_string("first document");
+  writer.reset();
+  writer.write_integer(42);
+  EXPECT_TRUE(writer.take_buffer().close());
+  EXPECT_EQ(read_file(), "42");
+}
+
+TEST_F(MmapFileTest, read_only_file)
+{
+  MmapCompactJsonWriter writer(JsonMmapFile{ m_read_only_fd });
+  writer.write_string("abc");
+  EXPECT_TRUE(writer.get_buffer().has_error());
+  EXPECT_TRUE(writer.get_buffer().has_overflow());
+  // The size of the output is still counted.
+  EXPECT_EQ(writer.get_buffer().size(), 5u);
+  EXPECT_FALSE(writer.take_buffer().close());
+}
+
+TEST_F(MmapFileTest, measure)
+{
+  MmapCompactJsonWriter writer(JsonMmapFile{ m_fd });
+  EXPECT_EQ(writer.measure([](auto& fragment) { write_integers(fragment); }), 8891u);
+  EXPECT_TRUE(writer.get_buffer().empty());
+}
+
+TEST_F(MmapFileTest, gather_mode_is_ignored)
+{
+  const std::string value(1000, 'x');
+  MmapCompactJsonWriter writer(JsonMmapFile{ m_fd });
+  writer.set_gather_mode(true);
+  writer.write_string_ref(value);
+  EXPECT_TRUE(writer.take_buffer().close());
+  EXPECT_EQ(read_file(), '"' + value + '"');
+}
+#endif
@@ -0,0 +1,119 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "json_writer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+template<class Writer>
+void
+write_record(Writer& writer, int id)
+{
+  writer.begin_record();
+  writer.begin_object();
+  writer.write_integer_field("id", id);
+  writer.begin_field("tags");
+  writer.begin_array();
+  writer.begin_array_item();
+  writer.write_string("a");
+  writer.end_array_item();
+  writer.end_array();
+  writer.end_field();
+  writer.end_object();
+  writer.end_record();
+}
+
+class VectorSink : public JsonSink
+{
+public:
+  void write(const char* data, size_t size) override { writes.emplace_back(data, size); }
+
+  std::vector<std::string> writes;
+};
+} // namespace
+
+TEST(NdjsonTest, records)
+{
+  JsonWriter writer;
+  write_record(writer, 1);
+  write_record(writer, 2);
+  EXPECT_EQ(writer.get_buffer(), "{\"id\":1,\"tags\":[\"a\"]}\n{\"id\":2,\"tags\":[\"a\"]}\n");
+}
+
+TEST(NdjsonTest, scalar_records)
+{
+  CompactJsonWriter writer;
+  writer.begin_record();
+  writer.write_integer(1);
+  writer.end_record();
+  writer.begin_record();
+  writer.write_string("x");
+  writer.end_record();
+  EXPECT_EQ(writer.get_buffer(), "1\n\"x\"\n");
+}
+
+TEST(NdjsonTest, pretty_mode_restored)
+{
+  JsonWriter writer;
+  writer.set_pretty(true);
+  write_record(writer, 1);
+  EXPECT_TRUE(writer.is_pretty());
+
+  writer.reset();
+  writer.begin_array();
+  writer.end_array();
+  EXPECT_EQ(writer.get_buffer(), "[\n]");
+}
+
+TEST(NdjsonTest, flush_by_record_count)
+{
+  VectorSink sink;
+  CompactJsonWriter writer;
+  writer.set_sink(&sink);
+  writer.set_max_batch_records(3);
+  for (int i = 0; i < 7; ++i)
+    write_record(writer, i);
+  writer.flush();
+
+  ASSERT_EQ(sink.writes.size(), 3u);
+  EXPECT_EQ(sink.writes[0], "{\"id\":0,\"tags\":[\"a\"]}\n{\"id\":1,\"tags\":[\"a\"]}\n{\"id\":2,\"tags\":[\"a\"]}\n");
+  EXPECT_EQ(sink.writes[2], "{\"id\":6,\"tags\":[\"a\"]}\n");
+}
+
+TEST(NdjsonTest, flush_by_size_keeps_records_whole)
+{
+  VectorSink sink;
+  CompactJsonWriter writer;
+  writer.set_sink(&sink, 10);
+  for (int i = 0; i < 4; ++i)
+    write_record(writer, i);
+
+  ASSERT_EQ(sink.writes.size(), 4u);
+  for (const std::string& write : sink.writes) {
+    EXPECT_EQ(write.back(), '\n');
+    EXPECT_EQ(write.find('\n'), write.size() - 1);
+  }
+}
@@ -0,0 +1,230 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "json_writer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+template<class Writer>
+void
+write_profile(Writer& writer)
+{
+  writer.begin_object();
+  writer.write_string_field("name", "Alice \"{[,:]}\" \\");
+  writer.write_integer_field("age", -42);
+  writer.write_float_field("height", 1.625);
+  writer.write_bool_field("is_admin", false);
+  writer.write_null_field("extra");
+  writer.begin_field("empty_object");
+  writer.begin_object();
+  writer.end_object();
+  writer.end_field();
+  writer.begin_field("empty_array");
+  writer.begin_array();
+  writer.end_array();
+  writer.end_field();
+  writer.begin_field("tags");
+  const int ids[] = { 1, 2, 3 };
+  writer.write_array(std::begin(ids), std::end(ids), [](Writer& w, int value) {
+    w.begin_object();
+    w.write_integer_field("id", value);
+    w.end_object();
+  });
+  writer.end_field();
+  writer.end_object();
+}
+
+std::string
+render_profile(bool pretty)
+{
+  JsonWriter writer;
+  writer.set_use_colors(false);
+  writer.set_pretty(pretty);
+  write_profile(writer);
+  return std::string(writer.get_buffer());
+}
+
+// Writes the profile in an object and an array, either directly or spliced.
+template<class Writer>
+void
+write_document(Writer& writer, const std::string* fragment)
+{
+  writer.begin_object();
+  writer.write_integer_field("before", 1);
+  writer.begin_field("profile");
+  if (fragment != nullptr)
+    writer.write_raw_json(*fragment);
+  else
+    write_profile(writer);
+  writer.end_field();
+  writer.begin_field("list");
+  writer.begin_array();
+  for (int i = 0; i < 2; ++i) {
+    writer.begin_array_item();
+    if (fragment != nullptr)
+      writer.write_raw_json(*fragment);
+    else
+      write_profile(writer);
+    writer.end_array_item();
+  }
+  writer.end_array();
+  writer.end_field();
+  writer.end_object();
+}
+} // namespace
+
+TEST(RawJsonTest, same_output_as_writing_the_values)
+{
+  for (bool fragment_pretty : { false, true }) {
+    const std::string fragment = render_profile(fragment_pretty);
+    for (bool pretty : { false, true }) {
+      for (bool colors : { false, true }) {
+        JsonWriter expected;
+        expected.set_pretty(pretty);
+        expected.set_use_colors(colors);
+        write_document(expected, nullptr);
+
+        JsonWriter writer;
+        writer.set_pretty(pretty);
+        writer.set_use_colors(colors);
+        write_document(writer, &fragment);
+        EXPECT_EQ(writer.get_buffer(), expected.get_buffer()) << fragment_pretty << pretty << colors;
+      }
+    }
+  }
+}
+
+TEST(RawJsonTest, compact_copied_as_is)
+{
+  // Whitespace inside strings, including escaped quotes, is kept.
+  CompactJsonWriter writer;
+  writer.begin_array();
+  writer.begin_array_item();
+  writer.write_raw_json("{\"a b\":[\"c \\\" d\",1]}");
+  writer.end_array_item();
+  writer.end_array();
+  EXPECT_EQ(writer.get_buffer(), "[{\"a b\":[\"c \\\" d\",1]}]");
+}
+
+TEST(RawJsonTest, compact_whitespace_removed)
+{
+  CompactJsonWriter writer;
+  writer.begin_array();
+  writer.begin_array_item();
+  writer.write_raw_json("{ \"a\" : 1 }");
+  writer.end_array_item();
+  writer.begin_array_item();
+  writer.write_raw_json("{ \"b c\": [1, 2] }");
+  writer.end_array_item();
+  writer.end_array();
+  EXPECT_EQ(writer.get_buffer(), "[{\"a\":1},{\"b c\":[1,2]}]");
+}
+
+TEST(RawJsonTest, whitespace_reflowed)
+{
+  JsonWriter writer;
+  writer.set_use_colors(false);
+  writer.set_pretty(true);
+  writer.write_raw_json(" {\r\n\t\"a\" :\n[ 1 ,\"x\\\"y\" ] , \"b\":{ } }\n");
+  EXPECT_EQ(writer.get_buffer(), "{\n  \"a\": [\n    1,\n    \"x\\\"y\"\n  ],\n  \"b\": {\n  }\n}");
+}
+
+TEST(RawJsonTest, scalars)
+{
+  JsonWriter writer;
+  writer.set_use_colors(false);
+  writer.set_pretty(true);
+  writer.begin_object();
+  writer.write_raw_json_field("string", "\"a\\\\\"");
+  writer.write_raw_json_field("number", "-1.5e3");
+  writer.write_raw_json_field("true", "true");
+  writer.write_raw_json_field("null", "null");
+  writer.end_object();
+  EXPECT_EQ(writer.get_buffer(),
+            "{\n  \"string\": \"a\\\\\",\n  \"number\": -1.5e3,\n  \"true\": true,\n  \"null\": null\n}");
+}
+
+TEST(RawJsonTest, json_key_field)
+{
+  static const JsonKey KEY("user");
+
+  CompactJsonWriter writer;
+  writer.begin_object();
+  writer.write_raw_json_field(KEY, "{\"id\":1}");
+  writer.end_object();
+  EXPECT_EQ(writer.get_buffer(), "{\"user\":{\"id\":1}}");
+}
+
+TEST(RawJsonTest, invalid_input_terminates)
+{
+  // The output is unspecified, but the input must not be read out of bounds.
+  for (const char* json : { "{", "[", "{\"a\"", "{\"a\":", "[1,", "}", "]", "{,]", "[}", "\"abc", "\"ab\\", ":" }) {
+    JsonWriter writer;
+    writer.set_use_colors(false);
+    writer.set_pretty(true);
+    writer.write_raw_json(json);
+  }
+}
+
+TEST(RawJsonTest, deep_nesting)
+{
+  // Deeper than a run of indentation.
+  constexpr int DEPTH = 40;
+  const auto write_nested = [](auto& writer) {
+    for (int i = 0; i < DEPTH; ++i) {
+      writer.begin_object();
+      writer.write_integer_field("level", i);
+      writer.begin_field("next");
+    }
+    writer.begin_array();
+    writer.end_array();
+    for (int i = 0; i < DEPTH; ++i) {
+      writer.end_field();
+      writer.end_object();
+    }
+  };
+
+  CompactJsonWriter fragment;
+  write_nested(fragment);
+  JsonWriter expected;
+  expected.set_use_colors(false);
+  expected.set_pretty(true);
+  expected.begin_array();
+  expected.begin_array_item();
+  write_nested(expected);
+  expected.end_array_item();
+  expected.end_array();
+
+  JsonWriter writer;
+  writer.set_use_colors(false);
+  writer.set_pretty(true);
+  writer.begin_array();
+  writer.begin_array_item();
+  writer.write_raw_json(std::string(fragment.get_buffer()));
+  writer.end_array_item();
+  writer.end_array();
+  EXPECT_EQ(writer.get_buffer(), expected.get_buffer());
+}
@@ -0,0 +1,164 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "json_writer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+
+namespace {
+void
+write_document(JsonWriter& writer)
+{
+  writer.begin_object();
+  writer.write_string_field("name", "Bob");
+  writer.begin_field("tags");
+  writer.begin_array();
+  writer.begin_array_item();
+  writer.write_integer(1);
+  writer.end_array_item();
+  writer.end_array();
+  writer.end_field();
+  writer.end_object();
+}
+
+std::string
+get_expected_output()
+{
+  JsonWriter writer;
+  write_document(writer);
+  return writer.get_buffer();
+}
+} // namespace
+
+TEST(ReuseTest, reset_keeps_capacity)
+{
+  JsonWriter writer;
+  write_document(writer);
+  const size_t capacity = writer.get_buffer().capacity();
+
+  writer.reset();
+  EXPECT_TRUE(writer.get_buffer().empty());
+  EXPECT_EQ(writer.get_buffer().capacity(), capacity);
+
+  write_document(writer);
+  EXPECT_EQ(writer.get_buffer(), get_expected_output());
+}
+
+TEST(ReuseTest, reset_in_the_middle_of_a_document)
+{
+  JsonWriter writer;
+  writer.begin_object();
+  writer.begin_field("foo");
+  writer.begin_array();
+  writer.reset();
+
+  write_document(writer);
+  EXPECT_EQ(writer.get_buffer(), get_expected_output());
+}
+
+TEST(ReuseTest, take_buffer)
+{
+  JsonWriter writer;
+  write_document(writer);
+  const char* data = writer.get_buffer().data();
+
+  std::string output = writer.take_buffer();
+  EXPECT_EQ(output, get_expected_output());
+  EXPECT_EQ(output.data(), data);
+  EXPECT_TRUE(writer.get_buffer().empty());
+
+  write_document(writer);
+  EXPECT_EQ(writer.get_buffer(), get_expected_output());
+}
+
+TEST(ReuseTest, swap_buffer)
+{
+  std::string recycled;
+  recycled.reserve(1024);
+  recycled = "stale content";
+  const char* recycled_data = recycled.data();
+
+  JsonWriter writer;
+  write_document(writer);
+  writer.swap_buffer(recycled);
+
+  EXPECT_EQ(recycled, get_expected_output());
+  EXPECT_TRUE(writer.get_buffer().empty());
+  EXPECT_EQ(writer.get_buffer().data(), recycled_data);
+
+  write_document(writer);
+  EXPECT_EQ(writer.get_buffer(), get_expected_output());
+}
+
+TEST(ReuseTest, pool_reuses_writers)
+{
+  const size_t free_count = JsonWriterPool<>::get_free_count();
+  JsonWriter* first_writer;
+  {
+    auto writer = JsonWriterPool<>::acquire();
+    first_writer = &*writer;
+    write_document(*writer);
+  }
+  EXPECT_EQ(JsonWriterPool<>::get_free_count(), free_count + 1);
+
+  auto writer = JsonWriterPool<>::acquire();
+  EXPECT_EQ(&*writer, first_writer);
+  EXPECT_EQ(JsonWriterPool<>::get_free_count(), free_count);
+  EXPECT_TRUE(writer->get_buffer().empty());
+  EXPECT_GT(writer->get_buffer().capacity(), get_expected_output().size());
+
+  write_document(*writer);
+  EXPECT_EQ(writer->get_buffer(), get_expected_output());
+}
+
+TEST(ReuseTest, pool_detaches_sink)
+{
+  std::string output;
+  JsonStringSink sink(output);
+  {
+    auto writer = JsonWriterPool<>::acquire();
+    writer->set_sink(&sink);
+  }
+
+  auto writer = JsonWriterPool<>::acquire();
+  write_document(*writer);
+  writer->flush();
+  EXPECT_TRUE(output.empty());
+  EXPECT_EQ(writer->get_buffer(), get_expected_output());
+}
+
+TEST(ReuseTest, pool_is_per_thread)
+{
+  JsonWriterPool<CompactJsonWriter>::prewarm(2, 4096);
+  EXPECT_GE(JsonWriterPool<CompactJsonWriter>::get_free_count(), 2u);
+
+  size_t other_thread_count = 1;
+  std::thread thread([&other_thread_count] { other_thread_count = JsonWriterPool<CompactJsonWriter>::get_free_count(); });
+  thread.join();
+  EXPECT_EQ(other_thread_count, 0u);
+
+  auto writer = JsonWriterPool<CompactJsonWriter>::acquire();
+  EXPECT_GE(writer->get_buffer().capacity(), 4096u);
+}
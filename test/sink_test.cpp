@@ -0,0 +1,162 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "json_writer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#ifdef JSON_WRITER_HAS_POSIX
+#include <unistd.h>
+#endif
+
+namespace {
+void
+write_document(JsonWriter& writer)
+{
+  writer.begin_object();
+  writer.write_string_field("name", "Bob");
+  writer.write_integer_field("age", 42);
+
+  writer.begin_field("children");
+  writer.begin_array();
+  for (int i = 0; i < 20; ++i) {
+    writer.begin_array_item();
+    writer.begin_object();
+    writer.write_string_field("name", "Alice");
+    writer.write_integer_field("age", i);
+    writer.write_bool_field("is_adult", false);
+    writer.end_object();
+    writer.end_array_item();
+  }
+  writer.end_array();
+  writer.end_field();
+
+  writer.write_null_field("extra");
+  writer.end_object();
+}
+
+std::string
+get_expected_output(bool pretty)
+{
+  JsonWriter writer;
+  writer.set_pretty(pretty);
+  write_document(writer);
+  return writer.get_buffer();
+}
+
+std::string
+read_file(FILE* file)
+{
+  std::string content;
+  std::rewind(file);
+  char buffer[256];
+  size_t size;
+  while ((size = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+    content.append(buffer, size);
+  return content;
+}
+} // namespace
+
+TEST(SinkTest, string_sink)
+{
+  for (bool pretty : { false, true }) {
+    std::string output;
+    JsonStringSink sink(output);
+    JsonWriter writer;
+    writer.set_pretty(pretty);
+    writer.set_sink(&sink, 16);
+    write_document(writer);
+    writer.flush();
+
+    EXPECT_EQ(output, get_expected_output(pretty));
+    EXPECT_TRUE(writer.get_buffer().empty());
+  }
+}
+
+TEST(SinkTest, staging_buffer_is_bounded)
+{
+  std::vector<std::string> chunks;
+  JsonCallbackSink sink([&chunks](std::string_view chunk) { chunks.emplace_back(chunk); });
+  JsonWriter writer;
+  writer.set_pretty(true);
+  writer.set_sink(&sink, 32);
+  write_document(writer);
+  writer.flush();
+
+  std::string output;
+  for (const std::string& chunk : chunks) {
+    EXPECT_LT(chunk.size(), 128u);
+    output += chunk;
+  }
+
+  EXPECT_GT(chunks.size(), 1u);
+  EXPECT_EQ(output, get_expected_output(true));
+}
+
+TEST(SinkTest, file_sink)
+{
+  FILE* file = std::tmpfile();
+  ASSERT_NE(file, nullptr);
+
+  JsonFileSink sink(file);
+  JsonWriter writer;
+  writer.set_pretty(false);
+  writer.set_sink(&sink, 64);
+  write_document(writer);
+  writer.flush();
+
+  EXPECT_FALSE(sink.has_error());
+  EXPECT_EQ(read_file(file), get_expected_output(false));
+  std::fclose(file);
+}
+
+#ifdef JSON_WRITER_HAS_POSIX
+TEST(SinkTest, fd_sink)
+{
+  FILE* file = std::tmpfile();
+  ASSERT_NE(file, nullptr);
+
+  JsonFdSink sink(fileno(file));
+  JsonWriter writer;
+  writer.set_pretty(true);
+  writer.set_sink(&sink, 64);
+  write_document(writer);
+  writer.flush();
+
+  EXPECT_FALSE(sink.has_error());
+  EXPECT_EQ(read_file(file), get_expected_output(true));
+  std::fclose(file);
+}
+#endif
+
+TEST(SinkTest, no_sink)
+{
+  JsonWriter writer;
+  writer.set_pretty(false);
+  write_document(writer);
+  writer.flush();
+  EXPECT_EQ(writer.get_buffer(), get_expected_output(false));
+}
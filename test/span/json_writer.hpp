@@ -0,0 +1,126 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Included instead of the real json_writer.hpp by json_writer_span_unittest,
+// which runs the writer tests with span writers: JsonWriter, CompactJsonWriter
+// and BasicJsonWriter then name writers storing their output in a span.
+
+#ifndef JSON_WRITER_SPAN_TEST_HPP
+#define JSON_WRITER_SPAN_TEST_HPP
+
+#include "../../json_writer.hpp"
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// Selects OwnedSpanBuffer as the output buffer of a writer.
+struct OwnedSpanStorage
+{
+};
+
+// Span buffer owning a memory block large enough for the tests, so that the
+// writers can be default-constructed like the allocating ones.
+class OwnedSpanBuffer : public JsonSpanBuffer
+{
+public:
+  static constexpr size_t CAPACITY = 4 * 1024 * 1024;
+
+  OwnedSpanBuffer()
+    : OwnedSpanBuffer(std::unique_ptr<char[]>(new char[CAPACITY]))
+  {
+  }
+  explicit OwnedSpanBuffer(const OwnedSpanStorage&)
+    : OwnedSpanBuffer()
+  {
+  }
+  OwnedSpanBuffer(const OwnedSpanBuffer& other)
+    : OwnedSpanBuffer()
+  {
+    append(other.view());
+  }
+  OwnedSpanBuffer(OwnedSpanBuffer&& other) = default;
+  OwnedSpanBuffer& operator=(const OwnedSpanBuffer& other)
+  {
+    clear();
+    append(other.view());
+    return *this;
+  }
+  OwnedSpanBuffer& operator=(OwnedSpanBuffer&& other) = default;
+
+  OwnedSpanStorage get_allocator() const { return {}; }
+
+  // Like the std::string of the allocating writers.
+  operator std::string() const { return std::string(view()); }
+  size_t find(std::string_view text) const { return view().find(text); }
+
+private:
+  explicit OwnedSpanBuffer(std::unique_ptr<char[]> storage)
+    : JsonSpanBuffer(storage.get(), CAPACITY)
+    , m_storage(std::move(storage))
+  {
+  }
+
+  std::unique_ptr<char[]> m_storage;
+};
+
+inline bool
+operator==(const OwnedSpanBuffer& lhs, std::string_view rhs)
+{
+  return !lhs.has_overflow() && lhs.view() == rhs;
+}
+
+inline bool
+operator==(std::string_view lhs, const OwnedSpanBuffer& rhs)
+{
+  return rhs == lhs;
+}
+
+inline bool
+operator==(const OwnedSpanBuffer& lhs, const OwnedSpanBuffer& rhs)
+{
+  return rhs == lhs.view() && !lhs.has_overflow();
+}
+
+inline void
+PrintTo(const OwnedSpanBuffer& buffer, std::ostream* os)
+{
+  *os << '"' << buffer.view() << '"';
+}
+
+namespace json_detail {
+template<>
+struct WriterBuffer<OwnedSpanStorage>
+{
+  using type = OwnedSpanBuffer;
+};
+} // namespace json_detail
+
+template<JsonMode Pretty, JsonMode Colored, JsonEscape Escape = JsonEscape::Default>
+using SpanTestWriter = BasicJsonWriter<Pretty, Colored, Escape, OwnedSpanStorage>;
+
+#define BasicJsonWriter SpanTestWriter
+#define JsonWriter SpanTestWriter<JsonMode::Runtime, JsonMode::Runtime>
+#define CompactJsonWriter SpanTestWriter<JsonMode::Off, JsonMode::Off>
+
+#endif
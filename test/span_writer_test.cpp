@@ -0,0 +1,269 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "json_writer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+template<class Writer>
+void
+write_document(Writer& writer)
+{
+  writer.begin_object();
+  writer.write_string_field("name", "Alice \"the\" \\ first\n");
+  writer.write_integer_field("age", -42);
+  writer.write_float_field("height", 1.625);
+  writer.write_float_field("weight", 60.0, 3);
+  writer.write_bool_field("is_adult", true);
+  writer.write_null_field("extra");
+  writer.begin_field("values");
+  writer.write_integer_array(std::vector<int>{ 1, 22, 333, 4444 });
+  writer.end_field();
+  writer.begin_field("ratios");
+  writer.write_float_array(std::vector<double>{ 0.5, 0.25 });
+  writer.end_field();
+  writer.write_string_field("long", std::string(100, 'x') + "\t" + std::string(100, 'y'));
+  writer.end_object();
+}
+
+std::string
+get_expected(bool pretty, bool colors)
+{
+  JsonWriter writer;
+  writer.set_pretty(pretty);
+  writer.set_use_colors(colors);
+  write_document(writer);
+  return writer.get_buffer();
+}
+
+class StringSink : public JsonSink
+{
+public:
+  void write(const char* data, size_t size) override { output.append(data, size); }
+
+  std::string output;
+};
+} // namespace
+
+TEST(SpanWriterTest, fits)
+{
+  const std::string expected = get_expected(false, false);
+  std::vector<char> storage(expected.size());
+  SpanCompactJsonWriter writer(JsonSpanBuffer(storage.data(), storage.size()));
+  write_document(writer);
+
+  EXPECT_FALSE(writer.get_buffer().has_overflow());
+  EXPECT_EQ(writer.get_buffer().size(), expected.size());
+  EXPECT_EQ(writer.get_buffer().view(), expected);
+  EXPECT_EQ(writer.get_buffer().data(), storage.data());
+}
+
+TEST(SpanWriterTest, every_capacity)
+{
+  for (bool pretty : { false, true }) {
+    for (bool colors : { false, true }) {
+      const std::string expected = get_expected(pretty, colors);
+      for (size_t capacity = 0; capacity <= expected.size() + 1; ++capacity) {
+        // One more byte to detect writes past the capacity.
+        std::vector<char> storage(capacity + 1, '#');
+        SpanJsonWriter writer(JsonSpanBuffer(storage.data(), capacity));
+        writer.set_pretty(pretty);
+        writer.set_use_colors(colors);
+        write_document(writer);
+
+        const JsonSpanBuffer& buffer = writer.get_buffer();
+        ASSERT_EQ(buffer.has_overflow(), capacity < expected.size()) << capacity;
+        ASSERT_EQ(buffer.size(), expected.size()) << capacity;
+        ASSERT_EQ(buffer.view(), std::string_view(expected).substr(0, buffer.view().size())) << capacity;
+        ASSERT_EQ(storage[capacity], '#') << capacity;
+      }
+    }
+  }
+}
+
+TEST(SpanWriterTest, overflow_until_reset)
+{
+  char storage[8];
+  SpanCompactJsonWriter writer(JsonSpanBuffer{ storage });
+  writer.write_string("too long for the span");
+  EXPECT_TRUE(writer.get_buffer().has_overflow());
+  EXPECT_EQ(writer.get_buffer().size(), 23u);
+
+  // Only the opening quote fits, and nothing is stored after an overflow even
+  // if it would fit.
+  writer.write_null();
+  EXPECT_TRUE(writer.get_buffer().has_overflow());
+  EXPECT_EQ(writer.get_buffer().view(), "\"");
+  EXPECT_EQ(writer.get_buffer().size(), 27u);
+
+  writer.reset();
+  writer.write_null();
+  EXPECT_FALSE(writer.get_buffer().has_overflow());
+  EXPECT_EQ(writer.get_buffer().view(), "null");
+}
+
+TEST(SpanWriterTest, overflow_larger_than_scratch)
+{
+  CompactJsonWriter reference;
+  reference.write_float(1e300, 3901);
+
+  char storage[8];
+  SpanCompactJsonWriter writer(JsonSpanBuffer{ storage });
+  writer.write_float(1e300, 3901);
+  EXPECT_TRUE(writer.get_buffer().has_overflow());
+  EXPECT_EQ(writer.get_buffer().size(), reference.get_buffer().size());
+
+  // Once it fits, the value is formatted in place.
+  std::vector<char> large_storage(8192);
+  SpanCompactJsonWriter large_writer(JsonSpanBuffer(large_storage.data(), large_storage.size()));
+  large_writer.write_float(1e300, 3901);
+  EXPECT_FALSE(large_writer.get_buffer().has_overflow());
+  EXPECT_EQ(large_writer.get_buffer().view(), reference.get_buffer());
+}
+
+TEST(SpanWriterTest, number_array_items_larger_than_scratch)
+{
+  // Each item is indented by more than the scratch size.
+  constexpr int DEPTH = 2100;
+  const std::vector<double> values = { 0.5, 1e300, -2.0 };
+  const auto write_nested = [&](auto& writer) {
+    for (int i = 0; i < DEPTH; ++i) {
+      writer.begin_array();
+      writer.begin_array_item();
+    }
+    writer.write_float_array(values);
+    for (int i = 0; i < DEPTH; ++i) {
+      writer.end_array_item();
+      writer.end_array();
+    }
+  };
+
+  BasicJsonWriter<JsonMode::On, JsonMode::Off> reference;
+  write_nested(reference);
+
+  char storage[64];
+  BasicJsonWriter<JsonMode::On, JsonMode::Off, JsonEscape::Default, JsonSpanBuffer> writer(JsonSpanBuffer{ storage });
+  write_nested(writer);
+  EXPECT_TRUE(writer.get_buffer().has_overflow());
+  EXPECT_EQ(writer.get_buffer().size(), reference.get_buffer().size());
+}
+
+TEST(SpanWriterTest, escape_policy)
+{
+  using Writer = BasicJsonWriter<JsonMode::Off, JsonMode::Off, JsonEscape::Ascii | JsonEscape::Controls, JsonSpanBuffer>;
+  const std::string value = "caf\xC3\xA9 \x01 \xF0\x9F\x98\x80 \xFF";
+  BasicJsonWriter<JsonMode::Off, JsonMode::Off, JsonEscape::Ascii | JsonEscape::Controls> reference;
+  reference.write_string(value);
+
+  char storage[64];
+  Writer writer(JsonSpanBuffer{ storage });
+  writer.write_string(value);
+  EXPECT_EQ(writer.get_buffer().view(), reference.get_buffer());
+
+  Writer small_writer(JsonSpanBuffer(storage, 10));
+  small_writer.write_string(value);
+  EXPECT_TRUE(small_writer.get_buffer().has_overflow());
+  EXPECT_EQ(small_writer.get_buffer().size(), reference.get_buffer().size());
+}
+
+TEST(SpanWriterTest, measure)
+{
+  char storage[16];
+  SpanJsonWriter writer(JsonSpanBuffer{ storage });
+  writer.set_pretty(true);
+  writer.set_use_colors(false);
+  const size_t size = writer.measure([](SpanJsonWriter& fragment) { write_document(fragment); });
+  EXPECT_EQ(size, get_expected(true, false).size());
+  EXPECT_TRUE(writer.get_buffer().empty());
+}
+
+TEST(SpanWriterTest, sink)
+{
+  // Values never take more than 512 bytes here.
+  char storage[1024];
+  StringSink sink;
+  SpanCompactJsonWriter writer(JsonSpanBuffer{ storage });
+  writer.set_sink(&sink, 512);
+  writer.begin_array();
+  for (int i = 0; i < 100; ++i) {
+    writer.begin_array_item();
+    write_document(writer);
+    writer.end_array_item();
+  }
+  writer.end_array();
+  writer.flush();
+  EXPECT_FALSE(writer.get_buffer().has_overflow());
+
+  CompactJsonWriter reference;
+  reference.begin_array();
+  for (int i = 0; i < 100; ++i) {
+    reference.begin_array_item();
+    write_document(reference);
+    reference.end_array_item();
+  }
+  reference.end_array();
+  EXPECT_EQ(sink.output, reference.get_buffer());
+}
+
+TEST(SpanWriterTest, incomplete_output_not_flushed)
+{
+  char storage[16];
+  StringSink sink;
+  SpanCompactJsonWriter writer(JsonSpanBuffer{ storage });
+  writer.set_sink(&sink, 8);
+  writer.write_string("too long for the span");
+  writer.flush();
+  EXPECT_TRUE(writer.get_buffer().has_overflow());
+  EXPECT_TRUE(sink.output.empty());
+}
+
+TEST(SpanWriterTest, gather_overflow)
+{
+  const std::string value(300, 'x');
+  char storage[16];
+  SpanCompactJsonWriter writer(JsonSpanBuffer{ storage });
+  writer.set_gather_mode(true);
+  writer.begin_array();
+  writer.begin_array_item();
+  writer.write_string_ref(value);
+  writer.end_array_item();
+  writer.begin_array_item();
+  writer.write_string("0123456789abcdef");
+  writer.end_array_item();
+  writer.begin_array_item();
+  writer.write_string_ref(value);
+  writer.end_array_item();
+  writer.end_array();
+  EXPECT_TRUE(writer.get_buffer().has_overflow());
+  EXPECT_EQ(writer.get_output_size(), 2 * (value.size() + 2) + 18 + 4);
+
+  // Only the stored output, up to the opening quote of the string that did not
+  // fit, with the first string referenced.
+  std::string output;
+  for (std::string_view segment : writer.get_segments())
+    output += segment;
+  EXPECT_EQ(output, "[\"" + value + "\",\"");
+}
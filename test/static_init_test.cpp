@@ -0,0 +1,62 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "json_writer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+// This file is linked before impl.cpp, so that its statics are initialized
+// first: the vectorized functions must be usable from static initializers.
+namespace {
+const std::string LONG_NAME(40, 'k');
+const JsonKey LONG_KEY(LONG_NAME + "\"");
+
+std::string
+write_statically()
+{
+  BasicJsonWriter<JsonMode::Off, JsonMode::Off, JsonEscape::Html | JsonEscape::ReplaceInvalidUtf8> writer;
+  writer.begin_array();
+  writer.begin_array_item();
+  writer.write_string(std::string(40, 'a') + "<\xff");
+  writer.end_array_item();
+  writer.begin_array_item();
+  writer.write_base64(std::vector<unsigned char>(30, 0xFF), JsonBase64::Url);
+  writer.end_array_item();
+  writer.end_array();
+  return std::string(writer.get_buffer());
+}
+
+const std::string STATIC_OUTPUT = write_statically();
+} // namespace
+
+TEST(StaticInitTest, json_key)
+{
+  EXPECT_EQ(LONG_KEY.get_quoted(), "\"" + LONG_NAME + "\\\"\":");
+}
+
+TEST(StaticInitTest, writer)
+{
+  EXPECT_EQ(STATIC_OUTPUT, "[\"" + std::string(40, 'a') + "\\u003c\xef\xbf\xbd\",\"" + std::string(40, '_') + "\"]");
+}
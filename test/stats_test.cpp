@@ -0,0 +1,222 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Built with JSON_WRITER_ENABLE_STATS or JSON_WRITER_ENABLE_CYCLE_STATS, see
+// CMakeLists.txt.
+#include "json_writer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+uint64_t
+get_counted_bytes(const JsonWriterStats& stats)
+{
+  return stats.nulls.bytes + stats.bools.bytes + stats.strings.bytes + stats.integers.bytes + stats.floats.bytes +
+         stats.formatted.bytes + stats.field_names.bytes + stats.structure.bytes;
+}
+
+template<class Writer>
+void
+write_document(Writer& writer)
+{
+  writer.begin_object();
+  writer.write_null_field("a");
+  writer.write_bool_field("b", true);
+  writer.write_string_field("c", "x\"y");
+  writer.write_integer_field("d", 1);
+  writer.write_float_field("e", 1.5);
+  writer.end_object();
+}
+
+class CountingSink : public JsonSink
+{
+public:
+  void write(const char*, size_t size) override { this->size += size; }
+
+  size_t size = 0;
+};
+} // namespace
+
+TEST(StatsTest, bytes_per_kind)
+{
+  CompactJsonWriter writer;
+  write_document(writer);
+  ASSERT_EQ(writer.get_buffer(), "{\"a\":null,\"b\":true,\"c\":\"x\\\"y\",\"d\":1,\"e\":1.5}");
+
+  const JsonWriterStats& stats = writer.get_stats();
+  EXPECT_EQ(stats.nulls.count, 1u);
+  EXPECT_EQ(stats.nulls.bytes, 4u);
+  EXPECT_EQ(stats.bools.bytes, 4u);
+  EXPECT_EQ(stats.strings.bytes, 6u);
+  EXPECT_EQ(stats.integers.bytes, 1u);
+  EXPECT_EQ(stats.floats.bytes, 3u);
+  EXPECT_EQ(stats.field_names.count, 5u);
+  EXPECT_EQ(stats.field_names.bytes, 24u);
+  EXPECT_EQ(stats.structure.count, 2u);
+  EXPECT_EQ(stats.structure.bytes, 2u);
+  EXPECT_EQ(get_counted_bytes(stats), writer.get_buffer().size());
+  EXPECT_EQ(stats.escaped_chars, 1u);
+  EXPECT_EQ(stats.indent_bytes, 0u);
+  EXPECT_EQ(stats.color_bytes, 0u);
+  EXPECT_EQ(stats.max_depth, 1);
+}
+
+TEST(StatsTest, pretty_and_colors)
+{
+  JsonWriter writer;
+  writer.set_pretty(true);
+  writer.set_use_colors(true);
+  write_document(writer);
+
+  const JsonWriterStats& stats = writer.get_stats();
+  EXPECT_EQ(get_counted_bytes(stats), writer.get_buffer().size());
+  // Five fields at depth 1 and the closing brace at depth 0.
+  EXPECT_EQ(stats.indent_bytes, 5u * 3 + 1);
+  // Each value and field name is colored, with a 7 bytes color and a 4 bytes
+  // reset.
+  EXPECT_EQ(stats.color_bytes, 10u * (7 + 4));
+}
+
+TEST(StatsTest, escape_policies)
+{
+  BasicJsonWriter<JsonMode::Off, JsonMode::Off, JsonEscape::Ascii> ascii_writer;
+  ascii_writer.write_string("caf\xC3\xA9 \xF0\x9F\x98\x80 \x01");
+  EXPECT_EQ(ascii_writer.get_stats().escaped_chars, 2u);
+
+  BasicJsonWriter<JsonMode::Off, JsonMode::Off, JsonEscape::RejectInvalidUtf8 | JsonEscape::Controls> reject_writer;
+  reject_writer.write_string("a\xFF\xC3\xA9\n");
+  EXPECT_EQ(reject_writer.get_stats().escaped_chars, 2u);
+}
+
+TEST(StatsTest, nesting_depth)
+{
+  CompactJsonWriter writer;
+  writer.begin_array();
+  for (int i = 0; i < 3; ++i) {
+    writer.begin_array_item();
+    writer.begin_array();
+  }
+  for (int i = 0; i < 3; ++i) {
+    writer.end_array();
+    writer.end_array_item();
+  }
+  writer.end_array();
+  EXPECT_EQ(writer.get_buffer(), "[[[[]]]]");
+  EXPECT_EQ(writer.get_stats().max_depth, 4);
+}
+
+TEST(StatsTest, buffer_growth)
+{
+  CompactJsonWriter writer;
+  writer.begin_array();
+  for (int i = 0; i < 10000; ++i) {
+    writer.begin_array_item();
+    writer.write_integer(i);
+    writer.end_array_item();
+  }
+  writer.end_array();
+
+  const JsonWriterStats& stats = writer.get_stats();
+  EXPECT_GT(stats.reallocations, 0u);
+  EXPECT_EQ(stats.peak_size, writer.get_buffer().size());
+  EXPECT_EQ(stats.integers.count, 10000u);
+  EXPECT_EQ(get_counted_bytes(stats), writer.get_buffer().size());
+
+  // A reserved buffer never grows.
+  CompactJsonWriter reserved_writer;
+  reserved_writer.reserve(writer.get_buffer().size());
+  reserved_writer.write_integer_array(std::vector<int>(10000, 7));
+  EXPECT_EQ(reserved_writer.get_stats().reallocations, 0u);
+  EXPECT_EQ(reserved_writer.get_stats().integers.count, 10000u);
+}
+
+TEST(StatsTest, sink)
+{
+  CountingSink sink;
+  CompactJsonWriter writer;
+  writer.set_sink(&sink, 256);
+  writer.write_float_array(std::vector<double>(10000, 0.25));
+  writer.flush();
+
+  const JsonWriterStats& stats = writer.get_stats();
+  EXPECT_EQ(stats.flushed_bytes, sink.size);
+  EXPECT_EQ(get_counted_bytes(stats), sink.size);
+  EXPECT_LT(stats.peak_size, sink.size);
+  EXPECT_EQ(stats.floats.count, 10000u);
+}
+
+TEST(StatsTest, parallel_fragments)
+{
+  std::vector<int> values(1000, 3);
+  CompactJsonWriter writer;
+  writer.write_array_parallel(values.begin(), values.end(), [](CompactJsonWriter& item, int value) {
+    item.write_integer(value);
+  });
+
+  const JsonWriterStats& stats = writer.get_stats();
+  EXPECT_EQ(stats.integers.count, 1000u);
+  EXPECT_EQ(get_counted_bytes(stats), writer.get_buffer().size());
+}
+
+TEST(StatsTest, callback_on_reset)
+{
+  std::vector<JsonWriterStats> reports;
+  CompactJsonWriter writer;
+  writer.set_stats_callback([&](const JsonWriterStats& stats) { reports.push_back(stats); });
+
+  write_document(writer);
+  const std::string output = writer.take_buffer();
+  ASSERT_EQ(reports.size(), 1u);
+  EXPECT_EQ(get_counted_bytes(reports[0]), output.size());
+  EXPECT_EQ(writer.get_stats().field_names.count, 0u);
+
+  writer.write_null();
+  writer.reset();
+  ASSERT_EQ(reports.size(), 2u);
+  EXPECT_EQ(reports[1].nulls.count, 1u);
+}
+
+TEST(StatsTest, reset_stats)
+{
+  CompactJsonWriter writer;
+  write_document(writer);
+  writer.reset_stats();
+  writer.write_integer(12);
+  EXPECT_EQ(writer.get_stats().integers.bytes, 2u);
+  EXPECT_EQ(writer.get_stats().strings.count, 0u);
+}
+
+TEST(StatsTest, cycles)
+{
+  CompactJsonWriter writer;
+  for (int i = 0; i < 1000; ++i)
+    writer.write_string("some text to escape \"\"");
+
+#ifdef JSON_WRITER_ENABLE_CYCLE_STATS
+  EXPECT_GT(writer.get_stats().strings.cycles, 0u);
+#else
+  EXPECT_EQ(writer.get_stats().strings.cycles, 0u);
+#endif
+}
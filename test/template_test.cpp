@@ -0,0 +1,216 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "json_writer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace {
+// Writes the document either with slots or with the given values.
+struct Values
+{
+  int64_t id;
+  std::string name;
+  double score;
+  bool active;
+};
+
+void
+write_document(JsonWriter& writer, const Values* values)
+{
+  writer.begin_object();
+  writer.begin_field("id");
+  values ? writer.write_integer(values->id) : writer.write_slot(JsonSlotKind::Integer);
+  writer.end_field();
+  writer.begin_field("user");
+  writer.begin_object();
+  writer.begin_field("name");
+  values ? writer.write_string(values->name) : writer.write_slot(JsonSlotKind::String);
+  writer.end_field();
+  writer.begin_field("score");
+  values ? writer.write_float(values->score) : writer.write_slot(JsonSlotKind::Float);
+  writer.end_field();
+  writer.end_object();
+  writer.end_field();
+  writer.begin_field("active");
+  values ? writer.write_bool(values->active) : writer.write_slot(JsonSlotKind::Bool);
+  writer.end_field();
+  writer.end_object();
+}
+
+std::string
+fill(const JsonTemplate& document, const Values& values)
+{
+  JsonTemplate::Filler filler = document.fill();
+  filler.write_integer(values.id);
+  filler.write_string(values.name);
+  filler.write_float(values.score);
+  filler.write_bool(values.active);
+  return filler.finish();
+}
+} // namespace
+
+TEST(TemplateTest, slots)
+{
+  JsonWriter writer;
+  writer.set_pretty(false);
+  write_document(writer, nullptr);
+  const JsonTemplate document(writer);
+
+  ASSERT_EQ(document.get_slot_count(), 4u);
+  EXPECT_EQ(document.get_slot_kind(0), JsonSlotKind::Integer);
+  EXPECT_EQ(document.get_slot_kind(1), JsonSlotKind::String);
+  EXPECT_EQ(document.get_slot_kind(2), JsonSlotKind::Float);
+  EXPECT_EQ(document.get_slot_kind(3), JsonSlotKind::Bool);
+
+  EXPECT_EQ(fill(document, { 1, "Bob", 0.5, true }),
+            R"({"id":1,"user":{"name":"Bob","score":0.5},"active":true})");
+  EXPECT_EQ(fill(document, { -7, "\"quoted\"", 1e10, false }),
+            R"({"id":-7,"user":{"name":"\"quoted\"","score":1e+10},"active":false})");
+}
+
+TEST(TemplateTest, same_output_as_writer)
+{
+  const Values values = { 42, "Alice\n", 175.6, true };
+  for (bool pretty : { false, true }) {
+    for (bool colors : { false, true }) {
+      JsonWriter template_writer;
+      template_writer.set_pretty(pretty);
+      template_writer.set_use_colors(colors);
+      write_document(template_writer, nullptr);
+      const JsonTemplate document(template_writer);
+
+      JsonWriter writer;
+      writer.set_pretty(pretty);
+      writer.set_use_colors(colors);
+      write_document(writer, &values);
+      EXPECT_EQ(fill(document, values), writer.get_buffer());
+    }
+  }
+}
+
+TEST(TemplateTest, null_and_non_finite)
+{
+  JsonWriter writer;
+  writer.set_pretty(false);
+  writer.set_non_finite(JsonNonFinite::String);
+  writer.begin_array();
+  writer.begin_array_item();
+  writer.write_slot(JsonSlotKind::Float);
+  writer.end_array_item();
+  writer.begin_array_item();
+  writer.write_slot(JsonSlotKind::String);
+  writer.end_array_item();
+  writer.end_array();
+  const JsonTemplate document(writer);
+
+  JsonTemplate::Filler filler = document.fill();
+  filler.write_float(NAN);
+  filler.write_null();
+  EXPECT_EQ(filler.finish(), R"(["NaN",null])");
+}
+
+TEST(TemplateTest, recycled_buffer)
+{
+  JsonWriter writer;
+  writer.write_slot(JsonSlotKind::Integer);
+  const JsonTemplate document(writer);
+
+  std::string buffer = "previous content";
+  JsonTemplate::Filler filler = document.fill(std::move(buffer));
+  filler.write_integer(5);
+  EXPECT_EQ(filler.finish(), "5");
+}
+
+namespace {
+JsonTemplate
+make_integer_and_string_template()
+{
+  JsonWriter writer;
+  writer.set_pretty(false);
+  writer.begin_object();
+  writer.begin_field("id");
+  writer.write_slot(JsonSlotKind::Integer);
+  writer.end_field();
+  writer.begin_field("name");
+  writer.write_slot(JsonSlotKind::String);
+  writer.end_field();
+  writer.end_object();
+  return JsonTemplate(writer);
+}
+} // namespace
+
+TEST(TemplateTest, wrong_kind)
+{
+  const JsonTemplate document = make_integer_and_string_template();
+  JsonTemplate::Filler filler = document.fill();
+  EXPECT_THROW(filler.write_string("1"), std::logic_error);
+  EXPECT_THROW(filler.write_float(1.0), std::logic_error);
+  EXPECT_THROW(filler.write_bool(true), std::logic_error);
+
+  // The filler is left unchanged.
+  filler.write_integer(1);
+  EXPECT_THROW(filler.write_integer(2), std::logic_error);
+  filler.write_string("a");
+  EXPECT_EQ(filler.finish(), R"({"id":1,"name":"a"})");
+}
+
+TEST(TemplateTest, too_many_values)
+{
+  const JsonTemplate document = make_integer_and_string_template();
+  JsonTemplate::Filler filler = document.fill();
+  filler.write_integer(1);
+  filler.write_null();
+  EXPECT_THROW(filler.write_null(), std::logic_error);
+  EXPECT_THROW(filler.write_integer(3), std::logic_error);
+  EXPECT_EQ(filler.finish(), R"({"id":1,"name":null})");
+}
+
+TEST(TemplateTest, unfilled_slots)
+{
+  const JsonTemplate document = make_integer_and_string_template();
+  JsonTemplate::Filler filler = document.fill();
+  EXPECT_THROW(filler.finish(), std::logic_error);
+  filler.write_integer(1);
+  EXPECT_THROW(filler.finish(), std::logic_error);
+  filler.write_string("a");
+  EXPECT_EQ(filler.finish(), R"({"id":1,"name":"a"})");
+}
+
+TEST(TemplateTest, escape_policy)
+{
+  BasicJsonWriter<JsonMode::Off, JsonMode::Off, JsonEscape::Html | JsonEscape::Ascii> template_writer;
+  template_writer.begin_array();
+  template_writer.begin_array_item();
+  template_writer.write_slot(JsonSlotKind::String);
+  template_writer.end_array_item();
+  template_writer.end_array();
+  const JsonTemplate document(template_writer);
+
+  JsonTemplate::Filler filler = document.fill();
+  filler.write_string("</script>\xc3\xa9");
+  EXPECT_EQ(filler.finish(), R"(["\u003c/script\u003e\u00e9"])");
+}
@@ -0,0 +1,171 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "json_writer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+template<class Writer>
+void
+write_document(Writer& writer)
+{
+  static const JsonKey TAGS_KEY("tags");
+
+  writer.begin_object();
+  writer.write_string_field("name", "Bob \"the\" builder\n");
+  writer.write_integer_field("age", 42);
+  writer.write_integer_field("big", std::numeric_limits<uint64_t>::max());
+  writer.write_float_field("height", 175.6);
+  writer.write_float_field("ratio", 0.1f);
+  writer.write_float_field("rounded", 2.0 / 3.0, 2);
+  writer.write_float_field("invalid", NAN);
+  writer.write_bool_field("is_adult", true);
+  writer.write_null_field("extra");
+  writer.begin_field(TAGS_KEY);
+  const std::vector<std::string> tags = { "a", std::string(200, 'x'), "" };
+  writer.write_array(tags.begin(), tags.end(), [](Writer& writer, const std::string& tag) { writer.write_string(tag); });
+  writer.end_field();
+  writer.begin_field("children");
+  writer.begin_array();
+  writer.end_array();
+  writer.end_field();
+  writer.end_object();
+}
+} // namespace
+
+TEST(TokenStreamTest, same_output_as_writer)
+{
+  JsonTokenStream tokens;
+  write_document(tokens);
+
+  for (bool pretty : { false, true }) {
+    for (bool colors : { false, true }) {
+      for (JsonNonFinite non_finite : { JsonNonFinite::Null, JsonNonFinite::String }) {
+        JsonWriter writer;
+        writer.set_pretty(pretty);
+        writer.set_use_colors(colors);
+        writer.set_non_finite(non_finite);
+        write_document(writer);
+
+        JsonWriter replay_writer;
+        replay_writer.set_pretty(pretty);
+        replay_writer.set_use_colors(colors);
+        replay_writer.set_non_finite(non_finite);
+        tokens.replay(replay_writer);
+        EXPECT_EQ(replay_writer.get_buffer(), writer.get_buffer());
+      }
+    }
+  }
+}
+
+TEST(TokenStreamTest, compile_time_modes)
+{
+  JsonTokenStream tokens;
+  write_document(tokens);
+
+  CompactJsonWriter writer;
+  write_document(writer);
+  CompactJsonWriter replay_writer;
+  tokens.replay(replay_writer);
+  EXPECT_EQ(replay_writer.get_buffer(), writer.get_buffer());
+}
+
+TEST(TokenStreamTest, replay_inside_document)
+{
+  JsonTokenStream tokens;
+  tokens.begin_object();
+  tokens.write_integer_field("id", 1);
+  tokens.end_object();
+
+  JsonWriter writer;
+  writer.set_pretty(false);
+  writer.begin_array();
+  for (int i = 0; i < 2; ++i) {
+    writer.begin_array_item();
+    tokens.replay(writer);
+    writer.end_array_item();
+  }
+  writer.end_array();
+  EXPECT_EQ(writer.get_buffer(), R"([{"id":1},{"id":1}])");
+}
+
+TEST(TokenStreamTest, clear)
+{
+  JsonTokenStream tokens;
+  tokens.write_null();
+  EXPECT_GT(tokens.get_size(), 0u);
+  tokens.clear();
+  EXPECT_EQ(tokens.get_size(), 0u);
+
+  JsonWriter writer;
+  tokens.replay(writer);
+  EXPECT_EQ(writer.get_buffer(), "");
+}
+
+namespace {
+template<class Writer>
+void
+write_escaped_document(Writer& writer)
+{
+  static const JsonKey KEY("\xc3\xa9<");
+
+  writer.begin_object();
+  writer.write_string_field("<b>", "</script>\xc3\xa9\x01");
+  writer.write_string_field(KEY, "plain");
+  writer.write_string_field("plain", "\"quoted\"");
+  writer.end_object();
+}
+
+template<JsonEscape Escape>
+void
+check_escape_policy()
+{
+  JsonTokenStream tokens;
+  write_escaped_document(tokens);
+
+  BasicJsonWriter<JsonMode::Off, JsonMode::Off, Escape> expected;
+  write_escaped_document(expected);
+  BasicJsonWriter<JsonMode::Off, JsonMode::Off, Escape> writer;
+  tokens.replay(writer);
+  EXPECT_EQ(writer.get_buffer(), expected.get_buffer());
+}
+} // namespace
+
+TEST(TokenStreamTest, escape_policy)
+{
+  check_escape_policy<JsonEscape::Default>();
+  check_escape_policy<JsonEscape::Html>();
+  check_escape_policy<JsonEscape::Ascii>();
+  check_escape_policy<JsonEscape::Controls | JsonEscape::Html>();
+
+  JsonTokenStream tokens;
+  tokens.write_string("</script>");
+  BasicJsonWriter<JsonMode::Off, JsonMode::Off, JsonEscape::Html> writer;
+  tokens.replay(writer);
+  EXPECT_EQ(writer.get_buffer(), R"("\u003c/script\u003e")");
+}
@@ -0,0 +1,111 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "json_writer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+struct Record
+{
+  int id;
+  std::string name;
+  double score;
+};
+
+std::vector<Record>
+make_records(int count)
+{
+  std::vector<Record> records;
+  for (int i = 0; i < count; ++i)
+    records.push_back({ i, "record \"" + std::to_string(i) + "\"", i * 0.25 });
+  return records;
+}
+
+template<class Writer>
+void
+write_record(Writer& writer, const Record& record)
+{
+  writer.begin_object();
+  writer.write_integer_field("id", record.id);
+  writer.write_string_field("name", record.name);
+  writer.write_float_field("score", record.score);
+  writer.end_object();
+}
+
+// Writes the records inside an object so that the array is indented.
+std::string
+write_records(const std::vector<Record>& records, bool pretty, bool use_colors, unsigned thread_count)
+{
+  JsonWriter writer;
+  writer.set_pretty(pretty);
+  writer.set_use_colors(use_colors);
+  writer.begin_object();
+  writer.write_integer_field("count", records.size());
+  writer.begin_field("records");
+  const auto func = [](JsonWriter& writer, const Record& record) { write_record(writer, record); };
+  if (thread_count == 0)
+    writer.write_array(records.begin(), records.end(), func);
+  else
+    writer.write_array_parallel(records.begin(), records.end(), func, thread_count);
+  writer.end_field();
+  writer.write_null_field("next");
+  writer.end_object();
+  return writer.get_buffer();
+}
+} // namespace
+
+TEST(WriteArrayParallelTest, same_output_as_sequential)
+{
+  const std::vector<Record> records = make_records(1000);
+  for (bool pretty : { false, true }) {
+    for (bool use_colors : { false, true }) {
+      const std::string expected = write_records(records, pretty, use_colors, 0);
+      for (unsigned thread_count : { 1u, 2u, 3u, 8u })
+        EXPECT_EQ(write_records(records, pretty, use_colors, thread_count), expected);
+    }
+  }
+}
+
+TEST(WriteArrayParallelTest, small_arrays)
+{
+  for (int count : { 0, 1, 2, 65, 130 }) {
+    const std::vector<Record> records = make_records(count);
+    EXPECT_EQ(write_records(records, true, false, 4), write_records(records, true, false, 0));
+  }
+}
+
+TEST(WriteArrayParallelTest, exception_is_propagated)
+{
+  const std::vector<Record> records = make_records(1000);
+  JsonWriter writer;
+  const auto func = [](JsonWriter& writer, const Record& record) {
+    if (record.id == 900)
+      throw std::runtime_error("bad record");
+    write_record(writer, record);
+  };
+  EXPECT_THROW(writer.write_array_parallel(records.begin(), records.end(), func, 4), std::runtime_error);
+}
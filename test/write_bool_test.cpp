@@ -82,7 +82,7 @@ TEST(WriteBoolTest, write_bool_field_true)
   writer.set_use_colors(false);
   writer.set_pretty(true);
   writer.write_bool_field("foo", true);
-  EXPECT_EQ(writer.get_buffer(), "\"foo\": true,\n");
+  EXPECT_EQ(writer.get_buffer(), "\"foo\": true");
 }
 
 TEST(WriteBoolTest, write_bool_field_false)
@@ -91,5 +91,5 @@ TEST(WriteBoolTest, write_bool_field_false)
   writer.set_use_colors(false);
   writer.set_pretty(true);
   writer.write_bool_field("foo", false);
-  EXPECT_EQ(writer.get_buffer(), "\"foo\": false,\n");
+  EXPECT_EQ(writer.get_buffer(), "\"foo\": false");
 }
@@ -34,7 +34,7 @@ TEST(WriteFieldTest, empty_uncolored_pretty)
   writer.begin_field("");
   writer.write_null();
   writer.end_field();
-  EXPECT_EQ(writer.get_buffer(), "\"\": null,\n");
+  EXPECT_EQ(writer.get_buffer(), "\"\": null");
 }
 
 TEST(WriteFieldTest, empty_default_color_pretty)
@@ -45,7 +45,7 @@ TEST(WriteFieldTest, empty_default_color_pretty)
   writer.begin_field("");
   writer.write_null();
   writer.end_field();
-  EXPECT_EQ(writer.get_buffer(), COLOR_FIELD "\"\":" COLOR_RESET " " COLOR_NULL "null" COLOR_RESET ",\n");
+  EXPECT_EQ(writer.get_buffer(), COLOR_FIELD "\"\":" COLOR_RESET " " COLOR_NULL "null" COLOR_RESET);
 }
 
 TEST(WriteFieldTest, empty_custom_color_pretty)
@@ -58,7 +58,7 @@ TEST(WriteFieldTest, empty_custom_color_pretty)
   writer.write_null();
   writer.end_field();
   EXPECT_EQ(writer.get_buffer(),
-            COLOR_PREFIX "0;1;2" COLOR_SUFFIX "\"\":" COLOR_RESET " " COLOR_NULL "null" COLOR_RESET ",\n");
+            COLOR_PREFIX "0;1;2" COLOR_SUFFIX "\"\":" COLOR_RESET " " COLOR_NULL "null" COLOR_RESET);
 }
 
 TEST(WriteFieldTest, empty_uncolored_compact)
@@ -69,7 +69,7 @@ TEST(WriteFieldTest, empty_uncolored_compact)
   writer.begin_field("");
   writer.write_null();
   writer.end_field();
-  EXPECT_EQ(writer.get_buffer(), "\"\":null,");
+  EXPECT_EQ(writer.get_buffer(), "\"\":null");
 }
 
 TEST(WriteFieldTest, empty_default_color_compact)
@@ -80,7 +80,7 @@ TEST(WriteFieldTest, empty_default_color_compact)
   writer.begin_field("");
   writer.write_null();
   writer.end_field();
-  EXPECT_EQ(writer.get_buffer(), COLOR_FIELD "\"\":" COLOR_RESET COLOR_NULL "null" COLOR_RESET ",");
+  EXPECT_EQ(writer.get_buffer(), COLOR_FIELD "\"\":" COLOR_RESET COLOR_NULL "null" COLOR_RESET);
 }
 
 TEST(WriteFieldTest, empty_custom_color_compact)
@@ -93,7 +93,7 @@ TEST(WriteFieldTest, empty_custom_color_compact)
   writer.write_null();
   writer.end_field();
   EXPECT_EQ(writer.get_buffer(),
-            COLOR_PREFIX "0;1;2" COLOR_SUFFIX "\"\":" COLOR_RESET COLOR_NULL "null" COLOR_RESET ",");
+            COLOR_PREFIX "0;1;2" COLOR_SUFFIX "\"\":" COLOR_RESET COLOR_NULL "null" COLOR_RESET);
 }
 
 TEST(WriteFieldTest, escape)
@@ -104,7 +104,7 @@ TEST(WriteFieldTest, escape)
   writer.begin_field("\"\\\n\r\t\f");
   writer.write_null();
   writer.end_field();
-  EXPECT_EQ(writer.get_buffer(), "\"\\\"\\\\\\n\\r\\t\\f\": null,\n");
+  EXPECT_EQ(writer.get_buffer(), "\"\\\"\\\\\\n\\r\\t\\f\": null");
 }
 
 TEST(WriteFieldTest, classic)
@@ -115,5 +115,25 @@ TEST(WriteFieldTest, classic)
   writer.begin_field("foo\nbar");
   writer.write_null();
   writer.end_field();
-  EXPECT_EQ(writer.get_buffer(), "\"foo\\nbar\": null,\n");
+  EXPECT_EQ(writer.get_buffer(), "\"foo\\nbar\": null");
+}
+
+TEST(WriteFieldTest, separators_pretty)
+{
+  JsonWriter writer;
+  writer.set_use_colors(false);
+  writer.set_pretty(true);
+  writer.write_null_field("foo");
+  writer.write_null_field("bar");
+  EXPECT_EQ(writer.get_buffer(), "\"foo\": null,\n\"bar\": null");
+}
+
+TEST(WriteFieldTest, separators_compact)
+{
+  JsonWriter writer;
+  writer.set_use_colors(false);
+  writer.set_pretty(false);
+  writer.write_null_field("foo");
+  writer.write_null_field("bar");
+  EXPECT_EQ(writer.get_buffer(), "\"foo\":null,\"bar\":null");
 }
@@ -26,6 +26,10 @@
 
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <limits>
+#include <string>
+
 TEST(WriteFloatTest, float_uncolored)
 {
   JsonWriter writer;
@@ -57,5 +61,106 @@ TEST(WriteFloatTest, write_float_field)
   writer.set_use_colors(false);
   writer.set_pretty(true);
   writer.write_float_field("foo", 3.14);
-  EXPECT_EQ(writer.get_buffer(), "\"foo\": 3.14,\n");
+  EXPECT_EQ(writer.get_buffer(), "\"foo\": 3.14");
+}
+
+namespace {
+template<class T>
+std::string
+to_json(T value)
+{
+  JsonWriter writer;
+  writer.set_use_colors(false);
+  writer.write_float(value);
+  return writer.get_buffer();
+}
+
+template<class T>
+std::string
+to_json(T value, int precision)
+{
+  JsonWriter writer;
+  writer.set_use_colors(false);
+  writer.write_float(value, precision);
+  return writer.get_buffer();
+}
+
+std::string
+to_json(double value, JsonNonFinite non_finite)
+{
+  JsonWriter writer;
+  writer.set_use_colors(false);
+  writer.set_non_finite(non_finite);
+  writer.write_float(value);
+  return writer.get_buffer();
+}
+} // namespace
+
+TEST(WriteFloatTest, shortest_round_trip)
+{
+  EXPECT_EQ(to_json(0.1), "0.1");
+  EXPECT_EQ(to_json(0.1 + 0.2), "0.30000000000000004");
+  EXPECT_EQ(to_json(100.0), "100");
+  EXPECT_EQ(to_json(-0.0), "-0");
+  EXPECT_EQ(to_json(1e300), "1e+300");
+  EXPECT_EQ(to_json(std::numeric_limits<double>::denorm_min()), "5e-324");
+  EXPECT_EQ(to_json(-std::numeric_limits<double>::max()), "-1.7976931348623157e+308");
+  EXPECT_EQ(to_json(3.14f), "3.14");
+  EXPECT_EQ(to_json(std::numeric_limits<float>::max()), "3.4028235e+38");
+}
+
+TEST(WriteFloatTest, fixed_precision)
+{
+  EXPECT_EQ(to_json(3.14159, 2), "3.14");
+  EXPECT_EQ(to_json(3.1, 3), "3.100");
+  EXPECT_EQ(to_json(-0.005, 1), "-0.0");
+  EXPECT_EQ(to_json(2.75, 0), "3");
+  EXPECT_EQ(to_json(1e20, 1), "100000000000000000000.0");
+  EXPECT_EQ(to_json(1e300, 2).size(), 304u);
+  EXPECT_EQ(to_json(12.5f, 1), "12.5");
+}
+
+TEST(WriteFloatTest, negative_precision)
+{
+  EXPECT_EQ(to_json(3.14159, -1), "3.141590");
+  EXPECT_EQ(to_json(3.14159, -25), "3.141590");
+  EXPECT_EQ(to_json(1e300, std::numeric_limits<int>::min()).size(), 308u);
+}
+
+TEST(WriteFloatTest, fixed_precision_field)
+{
+  JsonWriter writer;
+  writer.set_use_colors(false);
+  writer.set_pretty(true);
+  writer.write_float_field("foo", 3.14159, 3);
+  EXPECT_EQ(writer.get_buffer(), "\"foo\": 3.142");
+}
+
+TEST(WriteFloatTest, non_finite_null)
+{
+  EXPECT_EQ(to_json(std::nan(""), JsonNonFinite::Null), "null");
+  EXPECT_EQ(to_json(HUGE_VAL, JsonNonFinite::Null), "null");
+  EXPECT_EQ(to_json(std::nan(""), 2), "null");
+}
+
+TEST(WriteFloatTest, non_finite_string)
+{
+  EXPECT_EQ(to_json(std::nan(""), JsonNonFinite::String), "\"NaN\"");
+  EXPECT_EQ(to_json(HUGE_VAL, JsonNonFinite::String), "\"Infinity\"");
+  EXPECT_EQ(to_json(-HUGE_VAL, JsonNonFinite::String), "\"-Infinity\"");
+}
+
+TEST(WriteFloatTest, non_finite_literal)
+{
+  EXPECT_EQ(to_json(std::nan(""), JsonNonFinite::Literal), "NaN");
+  EXPECT_EQ(to_json(HUGE_VAL, JsonNonFinite::Literal), "Infinity");
+  EXPECT_EQ(to_json(-HUGE_VAL, JsonNonFinite::Literal), "-Infinity");
+}
+
+TEST(WriteFloatTest, non_finite_colored)
+{
+  JsonWriter writer;
+  writer.set_use_colors(true);
+  writer.write_float(std::nan(""));
+  EXPECT_EQ(writer.get_buffer(), COLOR_NULL "null" COLOR_RESET);
 }
@@ -26,6 +26,9 @@
 
 #include <gtest/gtest.h>
 
+#include <cstdint>
+#include <string>
+
 TEST(WriteIntegerTest, integer_uncolored)
 {
   JsonWriter writer;
@@ -81,5 +84,66 @@ TEST(WriteIntegerTest, write_integer_field)
   writer.set_use_colors(false);
   writer.set_pretty(true);
   writer.write_integer_field("foo", 42);
-  EXPECT_EQ(writer.get_buffer(), "\"foo\": 42,\n");
+  EXPECT_EQ(writer.get_buffer(), "\"foo\": 42");
+}
+
+TEST(WriteIntegerTest, limits)
+{
+  const auto to_json = [](auto value) {
+    JsonWriter writer;
+    writer.set_use_colors(false);
+    writer.write_integer(value);
+    return writer.get_buffer();
+  };
+
+  EXPECT_EQ(to_json(INT8_MIN), "-128");
+  EXPECT_EQ(to_json(static_cast<int8_t>(INT8_MIN)), "-128");
+  EXPECT_EQ(to_json(static_cast<uint8_t>(UINT8_MAX)), "255");
+  EXPECT_EQ(to_json(static_cast<int16_t>(INT16_MIN)), "-32768");
+  EXPECT_EQ(to_json(static_cast<uint16_t>(UINT16_MAX)), "65535");
+  EXPECT_EQ(to_json(INT32_MIN), "-2147483648");
+  EXPECT_EQ(to_json(UINT32_MAX), "4294967295");
+  EXPECT_EQ(to_json(INT64_MIN), "-9223372036854775808");
+  EXPECT_EQ(to_json(INT64_MAX), "9223372036854775807");
+}
+
+TEST(WriteIntegerTest, digit_count_boundaries)
+{
+  uint64_t power = 1;
+  for (int i = 0; i < 20; ++i) {
+    for (uint64_t value : { power - 1, power, power + 1 }) {
+      JsonWriter writer;
+      writer.set_use_colors(false);
+      writer.write_integer(value);
+      EXPECT_EQ(writer.get_buffer(), std::to_string(value));
+
+      JsonWriter negative_writer;
+      negative_writer.set_use_colors(false);
+      negative_writer.write_integer(-static_cast<int64_t>(value >> 1));
+      EXPECT_EQ(negative_writer.get_buffer(), std::to_string(-static_cast<int64_t>(value >> 1)));
+    }
+    power *= 10;
+  }
+}
+
+#ifdef __SIZEOF_INT128__
+TEST(WriteIntegerTest, int128)
+{
+  const auto to_json = [](auto value) {
+    JsonWriter writer;
+    writer.set_use_colors(false);
+    writer.write_integer(value);
+    return writer.get_buffer();
+  };
+
+  const unsigned __int128 max_unsigned = ~static_cast<unsigned __int128>(0);
+  const __int128 max_signed = static_cast<__int128>(max_unsigned >> 1);
+  EXPECT_EQ(to_json(max_unsigned), "340282366920938463463374607431768211455");
+  EXPECT_EQ(to_json(max_signed), "170141183460469231731687303715884105727");
+  EXPECT_EQ(to_json(-max_signed - 1), "-170141183460469231731687303715884105728");
+  EXPECT_EQ(to_json(static_cast<__int128>(UINT64_MAX) + 1), "18446744073709551616");
+  EXPECT_EQ(to_json(static_cast<unsigned __int128>(10000000000000000000ULL) * 10000000000000000000ULL),
+            "100000000000000000000000000000000000000");
+  EXPECT_EQ(to_json(static_cast<__int128>(-7)), "-7");
 }
+#endif
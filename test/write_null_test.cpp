@@ -57,5 +57,5 @@ TEST(WriteNullTest, write_null_field)
   writer.set_use_colors(false);
   writer.set_pretty(true);
   writer.write_null_field("foo");
-  EXPECT_EQ(writer.get_buffer(), "\"foo\": null,\n");
+  EXPECT_EQ(writer.get_buffer(), "\"foo\": null");
 }
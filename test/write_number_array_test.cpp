@@ -0,0 +1,153 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "json_writer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+// Output of the generic write_array() for the same values.
+template<class T, class F>
+std::string
+write_reference(const std::vector<T>& values, bool pretty, bool colors, F write_item)
+{
+  JsonWriter writer;
+  writer.set_pretty(pretty);
+  writer.set_use_colors(colors);
+  writer.begin_object();
+  writer.begin_field("values");
+  writer.write_array(values.begin(), values.end(), write_item);
+  writer.end_field();
+  writer.end_object();
+  return writer.get_buffer();
+}
+
+template<class T, class F>
+void
+check_number_array(const std::vector<T>& values, bool pretty, bool colors, F write_array)
+{
+  JsonWriter writer;
+  writer.set_pretty(pretty);
+  writer.set_use_colors(colors);
+  writer.begin_object();
+  writer.begin_field("values");
+  write_array(writer, values);
+  writer.end_field();
+  writer.end_object();
+  EXPECT_EQ(writer.get_buffer(), write_reference(values, pretty, colors, [](JsonWriter& w, T value) {
+              if constexpr (std::is_integral_v<T>)
+                w.write_integer(value);
+              else
+                w.write_float(value);
+            }));
+}
+} // namespace
+
+TEST(WriteNumberArrayTest, integers)
+{
+  const std::vector<int64_t> values = { 0, 1, -1, 42, std::numeric_limits<int64_t>::min(),
+                                        std::numeric_limits<int64_t>::max() };
+  for (bool pretty : { false, true }) {
+    for (bool colors : { false, true }) {
+      check_number_array(values, pretty, colors, [](JsonWriter& writer, const std::vector<int64_t>& values) {
+        writer.write_integer_array(values);
+      });
+    }
+  }
+}
+
+TEST(WriteNumberArrayTest, small_integers)
+{
+  const std::vector<int8_t> values = { -128, 127, 0, -1 };
+  JsonWriter writer;
+  writer.set_pretty(false);
+  writer.write_integer_array(values.data(), values.size());
+  EXPECT_EQ(writer.get_buffer(), "[-128,127,0,-1]");
+
+  const std::array<uint64_t, 2> unsigned_values = { 0, std::numeric_limits<uint64_t>::max() };
+  CompactJsonWriter compact_writer;
+  compact_writer.write_integer_array(unsigned_values);
+  EXPECT_EQ(compact_writer.get_buffer(), "[0,18446744073709551615]");
+}
+
+TEST(WriteNumberArrayTest, floats)
+{
+  const std::vector<double> values = { 0.0, -0.5, 1e300, 3.14159, -2.5e-300 };
+  for (bool pretty : { false, true }) {
+    for (bool colors : { false, true }) {
+      check_number_array(values, pretty, colors, [](JsonWriter& writer, const std::vector<double>& values) {
+        writer.write_float_array(values);
+      });
+    }
+  }
+}
+
+TEST(WriteNumberArrayTest, non_finite)
+{
+  const std::vector<float> values = { NAN, INFINITY, -INFINITY, 1.5f };
+
+  CompactJsonWriter writer;
+  writer.write_float_array(values);
+  EXPECT_EQ(writer.get_buffer(), "[null,null,null,1.5]");
+
+  writer.reset();
+  writer.set_non_finite(JsonNonFinite::String);
+  writer.write_float_array(values);
+  EXPECT_EQ(writer.get_buffer(), "[\"NaN\",\"Infinity\",\"-Infinity\",1.5]");
+
+  writer.reset();
+  writer.set_non_finite(JsonNonFinite::Literal);
+  writer.write_float_array(values);
+  EXPECT_EQ(writer.get_buffer(), "[NaN,Infinity,-Infinity,1.5]");
+}
+
+TEST(WriteNumberArrayTest, empty)
+{
+  CompactJsonWriter writer;
+  writer.write_integer_array(std::vector<int>());
+  EXPECT_EQ(writer.get_buffer(), "[]");
+}
+
+TEST(WriteNumberArrayTest, large_with_sink)
+{
+  std::vector<int> values(10000);
+  for (size_t i = 0; i < values.size(); ++i)
+    values[i] = static_cast<int>(i * 7919);
+
+  std::string output;
+  JsonStringSink sink(output);
+  CompactJsonWriter writer;
+  writer.set_sink(&sink, 1024);
+  writer.write_integer_array(values);
+  writer.flush();
+
+  CompactJsonWriter reference;
+  reference.write_array(values.begin(), values.end(), [](CompactJsonWriter& w, int value) { w.write_integer(value); });
+  EXPECT_EQ(output, reference.get_buffer());
+}
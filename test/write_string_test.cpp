@@ -26,6 +26,8 @@
 
 #include <gtest/gtest.h>
 
+#include <string>
+
 TEST(WriteStringTest, empty_uncolored)
 {
   JsonWriter writer;
@@ -73,5 +75,68 @@ TEST(WriteStringTest, write_string_field)
   writer.set_use_colors(false);
   writer.set_pretty(true);
   writer.write_string_field("foo", "bar");
-  EXPECT_EQ(writer.get_buffer(), "\"foo\": \"bar\",\n");
+  EXPECT_EQ(writer.get_buffer(), "\"foo\": \"bar\"");
+}
+
+TEST(WriteStringTest, long_unescaped)
+{
+  const std::string value(1000, 'a');
+  JsonWriter writer;
+  writer.set_use_colors(false);
+  writer.write_string(value);
+  EXPECT_EQ(writer.get_buffer(), "\"" + value + "\"");
+}
+
+TEST(WriteStringTest, escape_at_every_position)
+{
+  // Covers the vectorized fast path, the block boundaries and the scalar tail.
+  for (size_t size = 1; size <= 80; ++size) {
+    for (size_t pos = 0; pos < size; ++pos) {
+      std::string value(size, 'x');
+      value[pos] = '"';
+
+      JsonWriter writer;
+      writer.set_use_colors(false);
+      writer.write_string(value);
+      EXPECT_EQ(writer.get_buffer(),
+                "\"" + std::string(pos, 'x') + "\\\"" + std::string(size - pos - 1, 'x') + "\"");
+    }
+  }
+}
+
+TEST(WriteStringTest, long_escape)
+{
+  std::string value;
+  std::string expected = "\"";
+  for (int i = 0; i < 20; ++i) {
+    value += "abcdefghijklmnopqrstuvwxyz\"\\\n\r\t\f";
+    expected += "abcdefghijklmnopqrstuvwxyz\\\"\\\\\\n\\r\\t\\f";
+  }
+  expected += "\"";
+
+  JsonWriter writer;
+  writer.set_use_colors(false);
+  writer.write_string(value);
+  EXPECT_EQ(writer.get_buffer(), expected);
+}
+
+TEST(WriteStringTest, utf8)
+{
+  const std::string value = "h\xc3\xa9llo w\xc3\xb6rld \xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e \xf0\x9f\x98\x80 "
+                            "\xd0\xbf\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82 \"quoted\"";
+  JsonWriter writer;
+  writer.set_use_colors(false);
+  writer.write_string(value);
+  EXPECT_EQ(writer.get_buffer(),
+            "\"h\xc3\xa9llo w\xc3\xb6rld \xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e \xf0\x9f\x98\x80 "
+            "\xd0\xbf\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82 \\\"quoted\\\"\"");
+}
+
+TEST(WriteStringTest, other_control_characters)
+{
+  const std::string value = std::string(40, 'a') + "\x01\x1f" + std::string(40, 'b');
+  JsonWriter writer;
+  writer.set_use_colors(false);
+  writer.write_string(value);
+  EXPECT_EQ(writer.get_buffer(), "\"" + value + "\"");
 }
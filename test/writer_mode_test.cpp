@@ -0,0 +1,106 @@
+// MIT License
+//
+// Copyright (c) 2023 Hubert Gruniaux
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "json_writer.hpp"
+
+#include <gtest/gtest.h>
+
+namespace {
+template<class Writer>
+void
+write_document(Writer& writer)
+{
+  writer.begin_object();
+  writer.write_string_field("name", "Bob");
+  writer.write_integer_field("age", 42);
+  writer.write_float_field("height", 175.6);
+
+  writer.begin_field("children");
+  writer.begin_array();
+  writer.begin_array_item();
+  writer.begin_object();
+  writer.write_bool_field("is_adult", false);
+  writer.end_object();
+  writer.end_array_item();
+  writer.end_array();
+  writer.end_field();
+
+  writer.write_null_field("extra");
+  writer.end_object();
+}
+
+std::string
+get_runtime_output(bool pretty, bool use_colors)
+{
+  JsonWriter writer;
+  writer.set_pretty(pretty);
+  writer.set_use_colors(use_colors);
+  write_document(writer);
+  return writer.get_buffer();
+}
+
+template<JsonMode Pretty, JsonMode Colored>
+std::string
+get_static_output()
+{
+  BasicJsonWriter<Pretty, Colored> writer;
+  write_document(writer);
+  return writer.get_buffer();
+}
+} // namespace
+
+TEST(WriterModeTest, compact_uncolored)
+{
+  EXPECT_EQ((get_static_output<JsonMode::Off, JsonMode::Off>()), get_runtime_output(false, false));
+}
+
+TEST(WriterModeTest, compact_colored)
+{
+  EXPECT_EQ((get_static_output<JsonMode::Off, JsonMode::On>()), get_runtime_output(false, true));
+}
+
+TEST(WriterModeTest, pretty_uncolored)
+{
+  EXPECT_EQ((get_static_output<JsonMode::On, JsonMode::Off>()), get_runtime_output(true, false));
+}
+
+TEST(WriterModeTest, pretty_colored)
+{
+  EXPECT_EQ((get_static_output<JsonMode::On, JsonMode::On>()), get_runtime_output(true, true));
+}
+
+TEST(WriterModeTest, mixed)
+{
+  BasicJsonWriter<JsonMode::Off, JsonMode::Runtime> writer;
+  writer.set_use_colors(true);
+  write_document(writer);
+  EXPECT_EQ(writer.get_buffer(), get_runtime_output(false, true));
+}
+
+TEST(WriterModeTest, compact_alias)
+{
+  CompactJsonWriter writer;
+  EXPECT_FALSE(writer.is_pretty());
+  EXPECT_FALSE(writer.use_colors());
+  write_document(writer);
+  EXPECT_EQ(writer.get_buffer(), get_runtime_output(false, false));
+}